@@ -0,0 +1,40 @@
+// Walking the children of a wide element by index.
+//
+//   node benchmark/children.js
+import * as libxml from "../index.js";
+
+const CHILDREN = Number(process.env.CHILDREN ?? 200_000);
+
+const doc = libxml.parseXml(`<root>${'<c/>'.repeat(CHILDREN)}</root>`);
+const root = doc.root();
+
+const start = process.hrtime.bigint();
+let found = 0;
+for (let i = 0; i < CHILDREN; i += 1) {
+  if (root.child(i) !== null) {
+    found += 1;
+  }
+}
+const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+
+console.log(
+  `${found} of ${CHILDREN} children by index in ${elapsed.toFixed(1)} ms ` +
+    `(${((elapsed * 1e6) / CHILDREN).toFixed(0)} ns each)`
+);
+
+// copying every child into another document on the way, which changes the
+// children of that document's root only
+const out = new libxml.Document();
+const list = out.node('list');
+
+const copyStart = process.hrtime.bigint();
+for (let i = 0; i < CHILDREN; i += 1) {
+  list.addChild(new libxml.Element(out, root.child(i).name()));
+}
+const copyElapsed = Number(process.hrtime.bigint() - copyStart) / 1e6;
+
+console.log(
+  `${list.childNodes().length} children copied by index in ` +
+    `${copyElapsed.toFixed(1)} ms ` +
+    `(${((copyElapsed * 1e6) / CHILDREN).toFixed(0)} ns each)`
+);
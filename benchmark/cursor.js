@@ -0,0 +1,53 @@
+// Extracting fields from every record, with node wrappers and with a Cursor.
+//
+//   node benchmark/cursor.js
+import * as libxml from "../index.js";
+
+const ITEMS = Number(process.env.ITEMS ?? 100_000);
+
+const item = '<item id="i"><name>n</name><value>v</value></item>';
+const xml = `<root>${item.repeat(ITEMS)}</root>`;
+
+function withWrappers(doc) {
+  let fields = 0;
+  for (const node of doc.root().childNodes()) {
+    fields += node.attr('id').value().length;
+    for (const child of node.childNodes()) {
+      fields += child.name().length + child.text().length;
+    }
+  }
+  return fields;
+}
+
+function withCursor(doc) {
+  let fields = 0;
+  const cursor = new libxml.Cursor(doc);
+  if (!cursor.firstChild()) {
+    return fields;
+  }
+  do {
+    fields += cursor.attr('id').length;
+    if (cursor.firstChild()) {
+      do {
+        fields += cursor.name().length + cursor.text().length;
+      } while (cursor.next());
+      cursor.parent();
+    }
+  } while (cursor.next());
+  return fields;
+}
+
+for (const [label, walk] of [
+  ['wrappers', withWrappers],
+  ['cursor', withCursor],
+]) {
+  // a fresh document, so the wrapper walk does create every wrapper
+  const doc = libxml.parseXml(xml);
+
+  const start = process.hrtime.bigint();
+  const fields = walk(doc);
+  const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+
+  console.log(`${label}: ${ITEMS} records in ${elapsed.toFixed(1)} ms ` +
+    `(${fields} characters)`);
+}
@@ -0,0 +1,33 @@
+// Time spent wrapping the nodes of a deeply nested document.
+//
+//   node benchmark/deep.js
+import * as libxml from "../index.js";
+
+const DEPTH = Number(process.env.DEPTH ?? 2000);
+const ROUNDS = Number(process.env.ROUNDS ?? 20);
+
+const open = '<a><b/>'.repeat(DEPTH);
+const xml = `<root>${open}${'</a>'.repeat(DEPTH)}</root>`;
+
+function time(label, xpath) {
+  // a fresh document each round, so every node gets a new wrapper
+  const docs = Array.from({ length: ROUNDS }, () =>
+    libxml.parseXml(xml, { huge: true })
+  );
+
+  let wrapped = 0;
+  const start = process.hrtime.bigint();
+  for (const doc of docs) {
+    wrapped += doc.find(xpath).length;
+  }
+  const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+
+  console.log(
+    `${label}: ${wrapped} wrappers in ${elapsed.toFixed(1)} ms ` +
+      `(${((elapsed * 1e6) / wrapped).toFixed(0)} ns each)`
+  );
+}
+
+console.log(`depth ${DEPTH}, ${ROUNDS} rounds`);
+time('every element', '//*');
+time('leaves only', '//b');
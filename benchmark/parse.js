@@ -0,0 +1,35 @@
+// Parse throughput for large, node-heavy documents.
+//
+// Compare the allocators by running it twice:
+//   node benchmark/parse.js
+//   LIBXMLJS_DEBUG_MEMORY=1 node benchmark/parse.js
+import * as libxml from "../index.js";
+
+const ITERATIONS = Number(process.env.ITERATIONS ?? 20);
+const ELEMENTS = Number(process.env.ELEMENTS ?? 100_000);
+
+function makeDocument(count) {
+  const items = [];
+  for (let i = 0; i < count; i += 1) {
+    items.push(`<item id="${i}" kind="k${i % 7}"><name>n${i}</name>text</item>`);
+  }
+  return `<?xml version="1.0" encoding="UTF-8"?><root>${items.join('')}</root>`;
+}
+
+const xml = makeDocument(ELEMENTS);
+
+// warm up
+libxml.parseXml(xml);
+
+const start = process.hrtime.bigint();
+for (let i = 0; i < ITERATIONS; i += 1) {
+  libxml.parseXml(xml);
+}
+const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+
+const mb = (xml.length / (1024 * 1024)) * ITERATIONS;
+console.log(
+  `allocator: ${libxml.libxml_memory_debug ? 'debug' : 'counting'}, ` +
+    `${ITERATIONS} x ${ELEMENTS} elements: ${elapsed.toFixed(1)} ms ` +
+    `(${(mb / (elapsed / 1000)).toFixed(1)} MB/s)`
+);
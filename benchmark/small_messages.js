@@ -0,0 +1,47 @@
+// Per-message latency for small documents, where setting up a parser
+// context is a good share of the work.
+//
+// Runs with the parser context pool and again without it:
+//   node benchmark/small_messages.js
+import * as libxml from "../index.js";
+
+const ITERATIONS = Number(process.env.ITERATIONS ?? 100_000);
+const ELEMENTS = Number(process.env.ELEMENTS ?? 20);
+
+function makeMessage(count) {
+  const items = [];
+  for (let i = 0; i < count; i += 1) {
+    items.push(`<item id="${i}"><name>n${i}</name>text</item>`);
+  }
+  return `<?xml version="1.0"?><message>${items.join('')}</message>`;
+}
+
+const xml = makeMessage(ELEMENTS);
+const paragraphs = '<p class="x">text</p>'.repeat(ELEMENTS);
+const html = `<html><body>${paragraphs}</body></html>`;
+
+function run(label, parse, input) {
+  // warm up
+  for (let i = 0; i < 1000; i += 1) {
+    parse(input);
+  }
+
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < ITERATIONS; i += 1) {
+    parse(input);
+  }
+  const elapsed = Number(process.hrtime.bigint() - start) / 1e3;
+
+  console.log(
+    `${label}: ${input.length} bytes, ${ITERATIONS} parses, ` +
+      `${(elapsed / ITERATIONS).toFixed(2)} us/parse`
+  );
+}
+
+const { capacity } = libxml.parserPoolStats();
+for (const size of [capacity, 0]) {
+  libxml.setParserPoolSize(size);
+  const pool = size ? 'pooled' : 'unpooled';
+  run(`parseXml (${pool})`, libxml.parseXml, xml);
+  run(`parseHtml (${pool})`, libxml.parseHtml, html);
+}
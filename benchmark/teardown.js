@@ -0,0 +1,39 @@
+// Time spent collecting the wrappers of a large detached subtree.
+//
+//   node --expose-gc benchmark/teardown.js
+import * as libxml from "../index.js";
+
+const ITEMS = Number(process.env.ITEMS ?? 20_000);
+
+if (!global.gc) {
+  throw new Error('run with --expose-gc');
+}
+
+const items = '<item><name>n</name><value>v</value></item>'.repeat(ITEMS);
+const doc = libxml.parseXml(`<root><list>${items}</list></root>`);
+
+let collected = false;
+const registry = new FinalizationRegistry(() => {
+  collected = true;
+});
+
+let list = doc.get('//list');
+list.remove();
+let nodes = list.find('.//*');
+const wrappers = nodes.length + 1;
+registry.register(list, 'list');
+list = nodes = null;
+
+const start = process.hrtime.bigint();
+let passes = 0;
+while (!collected) {
+  global.gc();
+  passes += 1;
+  await new Promise((resolve) => setImmediate(resolve));
+}
+const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+
+console.log(
+  `${wrappers} wrappers in a detached subtree collected in ` +
+    `${elapsed.toFixed(1)} ms (${passes} gc passes)`
+);
@@ -0,0 +1,37 @@
+// Cost of creating node wrappers, per node type.
+//
+//   node benchmark/wrappers.js
+import * as libxml from "../index.js";
+
+const ITEMS = Number(process.env.ITEMS ?? 100_000);
+const ROUNDS = Number(process.env.ROUNDS ?? 5);
+
+const item = '<item id="i"><!--c--><?pi p?>text</item>';
+const xml = `<root>${item.repeat(ITEMS)}</root>`;
+
+const types = [
+  ['element', '//item'],
+  ['attribute', '//@id'],
+  ['text', '//text()'],
+  ['comment', '//comment()'],
+  ['processing instruction', '//processing-instruction()'],
+];
+
+console.log(`${ITEMS} nodes of each type, ${ROUNDS} rounds`);
+
+for (const [label, xpath] of types) {
+  // a fresh document each round, so every node gets a new wrapper
+  const docs = Array.from({ length: ROUNDS }, () => libxml.parseXml(xml));
+
+  let wrapped = 0;
+  const start = process.hrtime.bigint();
+  for (const doc of docs) {
+    wrapped += doc.find(xpath).length;
+  }
+  const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+
+  console.log(
+    `${label}: ${((elapsed * 1e6) / wrapped).toFixed(0)} ns per wrapper ` +
+      `(${wrapped} in ${elapsed.toFixed(1)} ms)`
+  );
+}
@@ -48,12 +48,19 @@
                 "src/xml_document.cc",
                 "src/xml_element.cc",
                 "src/xml_comment.cc",
+                "src/xml_cursor.cc",
                 "src/xml_namespace.cc",
                 "src/xml_node.cc",
+                "src/xml_parse_worker.cc",
+                "src/xml_parser_pool.cc",
+                "src/xml_record_splitter.cc",
                 "src/xml_sax_parser.cc",
+                "src/xml_schema.cc",
                 "src/xml_syntax_error.cc",
+                "src/xml_text_reader.cc",
                 "src/xml_textwriter.cc",
                 "src/xml_text.cc",
+                "src/xml_validate_worker.cc",
                 "src/xml_pi.cc",
                 "src/xml_xpath_context.cc",
                 "src/html_document.cc",
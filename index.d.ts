@@ -1,8 +1,15 @@
 import { EventEmitter } from 'node:events';
+import { Writable } from 'node:stream';
 
 export const version: string;
 export const libxml_version: string;
 export const libxml_parser_version: string;
+export const libxml_debug_enabled: boolean;
+/**
+ * Whether libxml2's debug allocator is in use (LIBXMLJS_DEBUG_MEMORY=1 at
+ * load time) instead of the default counting allocator.
+ */
+export const libxml_memory_debug: boolean;
 
 interface StringMap {
   [key: string]: string;
@@ -43,30 +50,93 @@ export interface ParserOptions {
   big_lines?: boolean;
   baseUrl?: string;
   encoding?: string;
+  /** Keep at most this many parse errors in `errors`, unlimited if unset. */
+  maxErrors?: number;
 }
 
-export type XmlParserOptions = ParserOptions;
+/**
+ * Parser options decoded once by createParserOptions(); accepted wherever
+ * an options object is.
+ */
+export declare class PreparedParserOptions {
+  private constructor();
+  private readonly __prepared: true;
+}
+
+export function createParserOptions(
+  options?: ParserOptions & { excludeImpliedElements?: boolean }
+): PreparedParserOptions;
+
+export type XmlParserOptions = ParserOptions | PreparedParserOptions;
 export function parseXml(source: string | Buffer, options?: XmlParserOptions): Document;
 export function parseXmlString(
   source: string,
   options?: XmlParserOptions
 ): Document;
 
-export type HtmlParserOptions = ParserOptions & {
-  excludeImpliedElements?: boolean;
-};
+export function parseXmlAsync(
+  source: string | Buffer,
+  options?: XmlParserOptions
+): Promise<Document>;
+
+export type HtmlParserOptions =
+  | (ParserOptions & { excludeImpliedElements?: boolean })
+  | PreparedParserOptions;
 export function parseHtml(source: string | Buffer, options?: HtmlParserOptions): Document;
 export function parseHtmlString(
   source: string,
   options?: HtmlParserOptions
 ): Document;
 
-export type HtmlFragmentParserOptions = Omit<HtmlParserOptions, "doctype" | "implied">;
+export function parseHtmlAsync(
+  source: string | Buffer,
+  options?: HtmlParserOptions
+): Promise<Document>;
+
+export type HtmlFragmentParserOptions =
+  | Omit<ParserOptions & { excludeImpliedElements?: boolean }, "doctype" | "implied">
+  | PreparedParserOptions;
 export function parseHtmlFragment(
   source: string | Buffer,
   options?: HtmlFragmentParserOptions
 ): Document;
 
+export class XPath {
+  constructor(expression: string);
+  toString(): string;
+}
+
+/**
+ * Compile an XPath expression once so repeated find / get calls skip parsing.
+ */
+export function compileXPath(expression: string): XPath;
+
+export interface XPathCacheStats {
+  hits: number;
+  misses: number;
+  size: number;
+  capacity: number;
+}
+
+/**
+ * Statistics for the cache of compiled expressions used by find / get.
+ */
+export function xpathCacheStats(): XPathCacheStats;
+export function setXPathCacheSize(size: number): void;
+
+export interface ParserPoolStats {
+  hits: number;
+  misses: number;
+  size: number;
+  capacity: number;
+}
+
+/**
+ * Statistics for the parser contexts reused by parseXml / parseHtml.
+ */
+export function parserPoolStats(): ParserPoolStats;
+export function setParserPoolSize(size: number): void;
+
 export function memoryUsage(): number;
 export function nodeCount(): number;
 
@@ -85,17 +155,27 @@ export class Document {
   childNodes(): Node[];
   encoding(): string;
   encoding(enc: string): this;
-  find<T extends Node = Node>(xpath: string, ns_uri?: string): T[];
-  find<T extends Node = Node>(xpath: string, namespaces: StringMap): T[];
-  get<T extends Node = Node>(xpath: string, ns_uri?: string): T | null;
-  get<T extends Node = Node>(xpath: string, namespaces: StringMap): T | null;
+  find<T extends Node = Node>(xpath: string | XPath, ns_uri?: string): T[];
+  find<T extends Node = Node>(xpath: string | XPath, namespaces: StringMap): T[];
+  get<T extends Node = Node>(xpath: string | XPath, ns_uri?: string): T | null;
+  get<T extends Node = Node>(
+    xpath: string | XPath,
+    namespaces: StringMap
+  ): T | null;
   node(name: string, content?: string): Element;
   root(): Element | null;
   root(newRoot: Node): Node;
   toString(formatted?: boolean): string;
   type(): 'document';
-  validate(xsdDoc: Document): boolean;
-  schematronValidate(schemaDoc: Document): boolean;
+  validate(xsd: Document | Schema): boolean;
+  /**
+   * Validate a copy of the document on the libuv threadpool. The document
+   * may be used and modified meanwhile, the result is for the document as it
+   * was when validateAsync was called.
+   */
+  validateAsync(xsd: Document | Schema): Promise<boolean>;
+  rngValidate(rng: Document | RelaxNGSchema): boolean;
+  schematronValidate(schema: Document | SchematronSchema): boolean;
   version(): string;
   setDtd(name: string, ext: string, sys: string): void;
   getDtd(): {
@@ -105,7 +185,42 @@ export class Document {
   };
 }
 
+/**
+ * An XSD compiled once and reused across validations.
+ */
+export class Schema {
+  /**
+   * @param source the XSD document, or an id from #share() to use a schema
+   *               compiled in another worker thread
+   */
+  constructor(source: Document | number);
+
+  /**
+   * Make the compiled schema available to other worker threads. The returned
+   * id stays valid as long as a Schema built from it is alive somewhere.
+   */
+  share(): number;
+}
+
+/**
+ * A RELAX NG grammar compiled once and reused across validations.
+ */
+export class RelaxNGSchema {
+  constructor(source: Document);
+}
+
+/**
+ * A Schematron schema compiled once and reused across validations.
+ */
+export class SchematronSchema {
+  constructor(source: Document);
+}
+
 export class Node {
+  /**
+   * The document the node was wrapped in, kept alive by the node
+   */
+  readonly document: Document | undefined;
   doc(): Document;
   parent(): Element | Document;
   /**
@@ -178,10 +293,13 @@ export class Element extends Node {
   addNextSibling<T extends Node>(siblingNode: T): T;
   addPrevSibling<T extends Node>(siblingNode: T): T;
 
-  find<T extends Node = Node>(xpath: string, ns_uri?: string): T[];
-  find<T extends Node = Node>(xpath: string, namespaces: StringMap): T[];
-  get<T extends Node = Node>(xpath: string, ns_uri?: string): T | null;
-  get<T extends Node = Node>(xpath: string, namespaces: StringMap): T | null;
+  find<T extends Node = Node>(xpath: string | XPath, ns_uri?: string): T[];
+  find<T extends Node = Node>(xpath: string | XPath, namespaces: StringMap): T[];
+  get<T extends Node = Node>(xpath: string | XPath, ns_uri?: string): T | null;
+  get<T extends Node = Node>(
+    xpath: string | XPath,
+    namespaces: StringMap
+  ): T | null;
 
   defineNamespace(prefixOrHref: string, hrefInCaseOfPrefix?: string): Namespace;
 
@@ -240,16 +358,219 @@ export class Namespace {
   prefix(): string;
 }
 
+export interface SaxParserOptions {
+  /**
+   * Collect events natively and emit them in batches of at most `events`
+   * events or `bytes` bytes of text (defaults 1024 and 65536).
+   */
+  batch?: boolean | { events?: number; bytes?: number };
+  /** Only report the element subtrees selected by this filter. */
+  filter?: SaxFilter;
+  /** Shape of the startElementNS attributes and namespaces. */
+  attributes?: SaxAttributeFormat;
+}
+
+/**
+ * 'arrays': [[localname, prefix, uri, value], ...] and [[prefix, uri], ...]
+ * 'flat': [localname, prefix, uri, value, ...] and [prefix, uri, ...]
+ * 'object': { 'prefix:localname': value } and { prefix (or ''): uri }
+ */
+export type SaxAttributeFormat = 'arrays' | 'flat' | 'object';
+
+/**
+ * Selects element subtrees by local name, namespace URI or streamable
+ * pattern (e.g. '//item', 'x:feed/x:entry'). Element, text, comment and
+ * CDATA events outside selected subtrees are dropped natively; document
+ * events and errors are always reported.
+ */
+export interface SaxFilter {
+  names?: string | string[];
+  uris?: string | string[];
+  patterns?: string | string[];
+  /** Prefixes used by the patterns, mapped to namespace URIs. */
+  namespaces?: Record<string, string>;
+}
+
+/**
+ * Element / attribute names reused from the parser's name cache.
+ */
+export interface SaxInternStats {
+  hits: number;
+  misses: number;
+  size: number;
+}
+
+export type SaxBatchCallback = (ops: Uint32Array, text: string) => void;
+
 export class SaxParser extends EventEmitter {
-  constructor();
-  parseString(source: string): boolean;
+  constructor(callbacks?: Record<string, (...args: any[]) => void>, options?: SaxParserOptions);
+  parseString(source: string | Uint8Array): boolean;
+  /**
+   * Tokenize on a native thread; events are emitted in batches on the JS
+   * thread while parsing continues.
+   */
+  parseStringAsync(source: string | Uint8Array, batch?: { events?: number; bytes?: number }): Promise<boolean>;
+  /**
+   * Receive raw event batches instead of events, see decodeSaxBatch().
+   * Passing null flushes pending events and switches back to events.
+   */
+  setBatchCallback(callback: SaxBatchCallback | null, maxEvents?: number, maxBytes?: number): void;
+  internStats(): SaxInternStats;
+  /** Replace the filter, null reports every element again. */
+  setFilter(filter: SaxFilter | null): void;
+  /** Get, or set and get, the shape of the startElementNS attributes. */
+  attributeFormat(format?: SaxAttributeFormat): SaxAttributeFormat;
 }
 
 export class SaxPushParser extends EventEmitter {
-  constructor();
-  push(source: string): boolean;
+  constructor(callbacks?: Record<string, (...args: any[]) => void>, options?: SaxParserOptions);
+  push(source: string | Uint8Array, terminate?: boolean): boolean;
+  /** Stop parsing without terminating the document and free the parser. */
+  close(): void;
+  setBatchCallback(callback: SaxBatchCallback | null, maxEvents?: number, maxBytes?: number): void;
+  internStats(): SaxInternStats;
+  /** Replace the filter, null reports every element again. */
+  setFilter(filter: SaxFilter | null): void;
+  /** Get, or set and get, the shape of the startElementNS attributes. */
+  attributeFormat(format?: SaxAttributeFormat): SaxAttributeFormat;
+  /**
+   * Validate against an XSD while parsing. Must be called before the first
+   * push; the outcome is emitted as a 'validated' event with
+   * (valid: boolean, errors: SyntaxError[]) once the parser is terminated.
+   */
+  plugSchema(xsd: Document | Schema): boolean;
+  /**
+   * Writable that pushes every chunk into this parser before the write
+   * completes and terminates the parser when the stream ends.
+   */
+  createWriteStream(): Writable;
+}
+
+/**
+ * Pull parser walking a document node by node. Only the current node is
+ * kept; string and Buffer sources stay in memory in whole, fromFile() reads
+ * the file as the reader moves on, in constant memory.
+ */
+export class TextReader {
+  static readonly ELEMENT: number;
+  static readonly ATTRIBUTE: number;
+  static readonly TEXT: number;
+  static readonly CDATA: number;
+  static readonly PROCESSING_INSTRUCTION: number;
+  static readonly COMMENT: number;
+  static readonly DOCUMENT_TYPE: number;
+  static readonly WHITESPACE: number;
+  static readonly SIGNIFICANT_WHITESPACE: number;
+  static readonly END_ELEMENT: number;
+
+  constructor(source: string | Buffer, options?: XmlParserOptions);
+  static fromFile(filename: string, options?: XmlParserOptions): TextReader;
+  /** Move to the next node, false once the document is done. */
+  read(): boolean;
+  /** Move past the subtree of the current node. */
+  next(): boolean;
+  nodeType(): number;
+  name(): string | null;
+  localName(): string | null;
+  prefix(): string | null;
+  namespaceUri(): string | null;
+  value(): string | null;
+  depth(): number;
+  isEmptyElement(): boolean;
+  hasValue(): boolean;
+  attributeCount(): number;
+  getAttribute(name: string): string | null;
+  attributes(): StringMap;
+  moveToFirstAttribute(): boolean;
+  moveToNextAttribute(): boolean;
+  moveToElement(): boolean;
+  /**
+   * Copy the subtree of the current element into a standalone document and
+   * return its root, null if the current node is no element.
+   */
+  expand(): Element | null;
+  errors(): SyntaxError[];
+  close(): void;
+}
+
+/**
+ * Read-only walk over the subtree of an element (the root element for a
+ * document) that moves a position instead of creating a Node per step.
+ * Moves return false, leaving the cursor where it was, if there is no such
+ * node within the subtree.
+ */
+export class Cursor {
+  constructor(node: Document | Element);
+  firstChild(): boolean;
+  next(): boolean;
+  parent(): boolean;
+  type(): string | null;
+  name(): string | null;
+  text(): string;
+  attr(name: string): string | null;
+  /** Levels below the node the cursor was created for. */
+  depth(): number;
+  /** Move back to the node the cursor was created for. */
+  reset(): void;
 }
 
+/**
+ * Decode a batch passed to a SaxBatchCallback, calling emit with the same
+ * arguments the unbatched events would have.
+ */
+export function decodeSaxBatch(
+  ops: Uint32Array,
+  text: string,
+  emit: (event: string, ...args: any[]) => void,
+  format?: SaxAttributeFormat
+): void;
+
+/**
+ * Parse a streamed document and iterate over its events as
+ * [event, ...listener arguments]; the next chunk is read once the events
+ * of the previous one were consumed.
+ */
+export function saxEvents(
+  stream: AsyncIterable<string | Uint8Array>,
+  batch?: { events?: number; bytes?: number }
+): AsyncIterableIterator<[string, ...any[]]>;
+
+/**
+ * Push parser that only builds the element subtrees selected by a filter.
+ * Each of them is returned as the root element of a document of its own
+ * once its end tag was parsed; the rest of the input is discarded.
+ */
+export class RecordSplitter {
+  constructor(filter: SaxFilter, options?: XmlParserOptions);
+  /** Records completed by this chunk. Throws on fatal parse errors. */
+  push(chunk: string | Uint8Array, terminate?: boolean): Element[];
+  errors(): SyntaxError[];
+  close(): void;
+}
+
+/**
+ * Parse a streamed document, yielding every element selected by the filter
+ * as the root of a small standalone document.
+ */
+export function splitRecords(
+  stream: AsyncIterable<string | Uint8Array>,
+  filter: SaxFilter,
+  options?: XmlParserOptions
+): AsyncIterableIterator<Element>;
+
+export interface StreamValidationResult {
+  valid: boolean;
+  errors: SyntaxError[];
+}
+
+/**
+ * Validate a streamed document against an XSD without building a tree.
+ */
+export function validateStream(
+  xsd: Document | Schema,
+  stream: AsyncIterable<string | Uint8Array>
+): Promise<StreamValidationResult>;
+
 export interface SyntaxError extends Error {
   domain: number | null;
   code: number | null;
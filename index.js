@@ -4,7 +4,14 @@
 import bindings from "./lib/bindings.js";
 
 import Document from "./lib/document.js";
-export { SaxParser, SaxPushParser } from "./lib/sax_parser.js";
+export {
+  SaxParser,
+  SaxPushParser,
+  decodeSaxBatch,
+  saxEvents,
+  splitRecords,
+  validateStream,
+} from "./lib/sax_parser.js";
 
 export { default as Document } from "./lib/document.js";
 export { default as Element } from "./lib/element.js";
@@ -12,12 +19,15 @@ export { default as Element } from "./lib/element.js";
 export const parseXml = Document.fromXml;
 export const parseHtml = Document.fromHtml;
 export const parseHtmlFragment = Document.fromHtmlFragment;
+export const parseXmlAsync = Document.fromXmlAsync;
+export const parseHtmlAsync = Document.fromHtmlAsync;
 export const parseXmlString = Document.fromXml;
 export const parseHtmlString = Document.fromHtml;
 export const version = "0.0.9";
 export const libxml_version = bindings.libxml_version;
 export const libxml_parser_version = bindings.libxml_parser_version;
 export const libxml_debug_enabled = bindings.libxml_debug_enabled;
+export const libxml_memory_debug = bindings.libxml_memory_debug;
 export const features = bindings.features;
 export const Comment = bindings.Comment;
 export const ProcessingInstruction = bindings.ProcessingInstruction;
@@ -25,4 +35,29 @@ export const Text = bindings.Text;
 export const memoryUsage = bindings.xmlMemUsed;
 export const nodeCount = bindings.xmlNodeCount;
 export const TextWriter = bindings.TextWriter;
+export const TextReader = bindings.TextReader;
+export const Cursor = bindings.Cursor;
+export const RecordSplitter = bindings.RecordSplitter;
+export const Schema = bindings.Schema;
+export const RelaxNGSchema = bindings.RelaxNGSchema;
+export const SchematronSchema = bindings.SchematronSchema;
+export const XPath = bindings.XPath;
+export const xpathCacheStats = bindings.xpathCacheStats;
+export const setXPathCacheSize = bindings.setXPathCacheSize;
+export const parserPoolStats = bindings.parserPoolStats;
+export const setParserPoolSize = bindings.setParserPoolSize;
+
+// / decode parser options once for reuse with any number of parses
+// / @param options parser options as taken by parseXml / parseHtml
+// / @return a ParserOptions handle accepted wherever options are
+export function createParserOptions(options) {
+  return new bindings.ParserOptions(options);
+}
+
+// / compile an xpath expression once for reuse with find / get
+// / @param expression xpath expression
+// / @return an XPath handle
+export function compileXPath(expression) {
+  return new bindings.XPath(expression);
+}
 
@@ -101,10 +101,9 @@ function fromHtmlFragment(string, opts = {}) {
     throw new Error('fromHtmlFragment options must be an object');
   }
 
-  opts.doctype = false;
-  opts.implied = false;
-
-  return bindings.fromHtml(string, opts);
+  // parsed without doctype and implied elements, like doctype: false and
+  // implied: false would
+  return bindings.fromHtml(string, opts, true);
 };
 
 // / parse a string into a xml document
@@ -114,9 +113,31 @@ function fromXml(string, options = {}) {
   return bindings.fromXml(string, options);
 };
 
+// / parse a string into a html document on the libuv threadpool
+// / @param string html string to parse
+// / @param {encoding:string, baseUrl:string} opts html string to parse
+// / @return a Promise resolving to a Document
+function fromHtmlAsync(string, opts = {}) {
+  // if for some reason user did not specify an object for the options
+  if (typeof opts !== 'object') {
+    return Promise.reject(new Error('fromHtmlAsync options must be an object'));
+  }
+
+  return bindings.fromHtmlAsync(string, opts);
+};
+
+// / parse a string into a xml document on the libuv threadpool
+// / @param string xml string to parse
+// / @return a Promise resolving to a Document
+function fromXmlAsync(string, options = {}) {
+  return bindings.fromXmlAsync(string, options);
+};
+
 Document.fromXml = fromXml;
 Document.fromHtml = fromHtml;
 Document.fromHtmlFragment = fromHtmlFragment;
+Document.fromXmlAsync = fromXmlAsync;
+Document.fromHtmlAsync = fromHtmlAsync;
 
 export default Document;
 
@@ -1,7 +1,138 @@
 import events from "node:events";
+import { Writable } from "node:stream";
 import bindings from "./bindings.js";
 
-const SaxParser = function SaxParser(callbacks) {
+// event types of a batch, see XmlSaxBatch in src/xml_sax_parser.h
+const START_DOCUMENT = 1;
+const END_DOCUMENT = 2;
+const START_ELEMENT_NS = 3;
+const END_ELEMENT_NS = 4;
+const CHARACTERS = 5;
+const COMMENT = 6;
+const CDATA = 7;
+const WARNING = 8;
+const ERROR = 9;
+
+const NULL_STRING = 0xffffffff;
+
+// / decode a batch of SAX events as delivered to setBatchCallback
+// / @param ops Uint32Array of event records
+// / @param text string the records slice their strings from
+// / @param emit called as emit(event, ...args) for every event, with the same
+// /             arguments as the unbatched events
+// / @param format shape of the startElementNS attributes and namespaces,
+// /               'arrays' (default), 'flat' or 'object'
+const decodeSaxBatch = function decodeSaxBatch(ops, text, emit, format) {
+  let i = 0;
+
+  const str = () => {
+    const offset = ops[i];
+    const length = ops[i + 1];
+
+    i += 2;
+    return length === NULL_STRING ? null : text.slice(offset, offset + length);
+  };
+
+  while (i < ops.length) {
+    const type = ops[i];
+
+    i += 1;
+    switch (type) {
+      case START_DOCUMENT:
+        emit('startDocument');
+        break;
+      case END_DOCUMENT:
+        emit('endDocument');
+        break;
+      case START_ELEMENT_NS: {
+        const localname = str();
+        const prefix = str();
+        const uri = str();
+        const attributeCount = ops[i];
+        const namespaceCount = ops[i + 1];
+        let attributes;
+        let namespaces;
+
+        i += 2;
+        if (format === 'object') {
+          attributes = {};
+          for (let j = 0; j < attributeCount; j += 1) {
+            const name = str();
+            const attributePrefix = str();
+
+            str();
+            attributes[
+              attributePrefix ? `${attributePrefix}:${name}` : name
+            ] = str();
+          }
+          namespaces = {};
+          for (let j = 0; j < namespaceCount; j += 1) {
+            namespaces[str() || ''] = str();
+          }
+        } else if (format === 'flat') {
+          attributes = new Array(attributeCount * 4);
+          for (let j = 0; j < attributes.length; j += 1) {
+            attributes[j] = str();
+          }
+          namespaces = new Array(namespaceCount * 2);
+          for (let j = 0; j < namespaces.length; j += 1) {
+            namespaces[j] = str();
+          }
+        } else {
+          attributes = new Array(attributeCount);
+          for (let j = 0; j < attributeCount; j += 1) {
+            attributes[j] = [str(), str(), str(), str()];
+          }
+          namespaces = new Array(namespaceCount);
+          for (let j = 0; j < namespaceCount; j += 1) {
+            namespaces[j] = [str(), str()];
+          }
+        }
+        emit('startElementNS', localname, attributes, prefix, uri, namespaces);
+        break;
+      }
+      case END_ELEMENT_NS:
+        emit('endElementNS', str(), str(), str());
+        break;
+      case CHARACTERS:
+        emit('characters', str());
+        break;
+      case COMMENT:
+        emit('comment', str());
+        break;
+      case CDATA:
+        emit('cdata', str());
+        break;
+      case WARNING:
+        emit('warning', str());
+        break;
+      case ERROR:
+        emit('error', str());
+        break;
+      default:
+        throw new Error(`Unknown SAX batch event ${type}`);
+    }
+  }
+};
+
+// / collect events natively and emit them in batches, which saves a native
+// / to JS transition per event
+// / @param batch true, or { events, bytes } limits of a single batch
+function enableBatching(parser, batch) {
+  const { events: maxEvents = 1024, bytes: maxBytes = 65536 } =
+    batch === true ? {} : batch;
+
+  const emit = (...args) => parser.emit(...args);
+
+  // the format may be changed after batching was enabled
+  parser.setBatchCallback(
+    (ops, text) => decodeSaxBatch(ops, text, emit, parser.attributeFormat()),
+    maxEvents,
+    maxBytes
+  );
+}
+
+const SaxParser = function SaxParser(callbacks, options) {
   const parser = new bindings.SaxParser();
 
   // attach callbacks
@@ -9,6 +140,18 @@ const SaxParser = function SaxParser(callbacks) {
     parser.on(callback, callbacks[callback]);
   }
 
+  if (options && options.filter) {
+    parser.setFilter(options.filter);
+  }
+
+  if (options && options.attributes) {
+    parser.attributeFormat(options.attributes);
+  }
+
+  if (options && options.batch) {
+    enableBatching(parser, options.batch);
+  }
+
   return parser;
 };
 
@@ -17,7 +160,28 @@ const SaxParser = function SaxParser(callbacks) {
 for (const k in events.EventEmitter.prototype)
   bindings.SaxParser.prototype[k] = events.EventEmitter.prototype[k];
 
-const SaxPushParser = function SaxPushParser(callbacks) {
+// / tokenize on a native thread of its own, the events are emitted in
+// / batches on this thread while parsing continues
+// / @param str xml string or Buffer
+// / @param batch optional { events, bytes } limits of a single batch
+// / @return promise resolved once all events were emitted, rejected with
+// /         the first exception thrown by a listener
+bindings.SaxParser.prototype.parseStringAsync = function parseStringAsync(
+  str,
+  batch
+) {
+  const { events: maxEvents = 1024, bytes: maxBytes = 65536 } = batch || {};
+  const emit = (...args) => this.emit(...args);
+
+  return this._parseStringAsync(
+    str,
+    (ops, text) => decodeSaxBatch(ops, text, emit, this.attributeFormat()),
+    maxEvents,
+    maxBytes
+  );
+};
+
+const SaxPushParser = function SaxPushParser(callbacks, options) {
   const parser = new bindings.SaxPushParser();
 
   // attach callbacks
@@ -25,6 +189,18 @@ const SaxPushParser = function SaxPushParser(callbacks) {
     parser.on(callback, callbacks[callback]);
   }
 
+  if (options && options.filter) {
+    parser.setFilter(options.filter);
+  }
+
+  if (options && options.attributes) {
+    parser.attributeFormat(options.attributes);
+  }
+
+  if (options && options.batch) {
+    enableBatching(parser, options.batch);
+  }
+
   return parser;
 };
 
@@ -33,4 +209,125 @@ const SaxPushParser = function SaxPushParser(callbacks) {
 for (const k in events.EventEmitter.prototype)
   bindings.SaxPushParser.prototype[k] = events.EventEmitter.prototype[k];
 
-export { SaxParser, SaxPushParser };
+// / writable stream feeding this parser, so a readable can be piped into it;
+// / every chunk is pushed before the write completes and the parser is
+// / terminated when the stream ends. A listener throwing fails the stream.
+// / @return Writable accepting strings, Buffers and Uint8Arrays
+bindings.SaxPushParser.prototype.createWriteStream =
+  function createWriteStream() {
+    const parser = this;
+
+    return new Writable({
+      decodeStrings: false,
+      write(chunk, encoding, callback) {
+        try {
+          parser.push(chunk);
+        } catch (err) {
+          callback(err);
+          return;
+        }
+        callback();
+      },
+      final(callback) {
+        try {
+          parser.push('', true);
+        } catch (err) {
+          callback(err);
+          return;
+        }
+        callback();
+      },
+    });
+  };
+
+// / parse a stream with a new push parser and iterate over its events, the
+// / next chunk is only read once the events of the previous one were taken
+// / @param stream readable stream or async iterable of xml chunks
+// / @param batch optional { events, bytes } limits of a single native batch
+// / @return async iterator of [event, ...args] arrays, the arguments being
+// /         the ones passed to the listeners of the event
+const saxEvents = async function* saxEvents(stream, batch) {
+  const parser = new bindings.SaxPushParser();
+  const { events: maxEvents = 1024, bytes: maxBytes = 65536 } = batch || {};
+  let queue = [];
+
+  parser.setBatchCallback(
+    (ops, text) =>
+      decodeSaxBatch(ops, text, (...event) => {
+        queue.push(event);
+      }),
+    maxEvents,
+    maxBytes
+  );
+
+  // a consumer breaking out early leaves the document unterminated
+  try {
+    for await (const chunk of stream) {
+      parser.push(chunk);
+
+      const ready = queue;
+      queue = [];
+      yield* ready;
+    }
+    parser.push('', true);
+
+    yield* queue;
+  } finally {
+    parser.close();
+  }
+};
+
+// / split a streamed document into records: every element selected by the
+// / filter is yielded as the root of a small document of its own once its
+// / end tag was parsed, nothing else of the document is kept in memory
+// / @param stream readable stream or async iterable of xml chunks
+// / @param filter { names, uris, patterns, namespaces } selecting records
+// / @param options parser options as taken by parseXml
+// / @return async iterator of Elements
+const splitRecords = async function* splitRecords(stream, filter, options) {
+  const splitter = new bindings.RecordSplitter(filter, options);
+
+  try {
+    for await (const chunk of stream) {
+      yield* splitter.push(chunk);
+    }
+    yield* splitter.push('', true);
+  } finally {
+    splitter.close();
+  }
+};
+
+// / validate an xml document against an XSD while it streams in, without
+// / building a tree, memory use does not depend on the document size
+// / @param schema compiled Schema or XSD Document
+// / @param stream readable stream or async iterable of xml chunks
+// / @return promise of { valid, errors }
+const validateStream = async function validateStream(schema, stream) {
+  const parser = new bindings.SaxPushParser();
+  let result = null;
+
+  parser.plugSchema(schema);
+  parser.on('validated', (valid, errors) => {
+    result = { valid, errors };
+  });
+
+  // parse errors are reported through the result as well
+  parser.on('error', () => {});
+
+  // Buffers are pushed as they are, libxml detects their encoding
+  for await (const chunk of stream) {
+    parser.push(chunk);
+  }
+  parser.push('', true);
+
+  return result;
+};
+
+export {
+  SaxParser,
+  SaxPushParser,
+  decodeSaxBatch,
+  saxEvents,
+  splitRecords,
+  validateStream,
+};
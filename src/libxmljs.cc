@@ -1,15 +1,25 @@
 // Copyright 2009, Squish Tech, LLC.
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
 #include <napi.h>
 
 #include <libxml/xmlmemory.h>
 
 #include "libxmljs.h"
+#include "xml_cursor.h"
 #include "xml_document.h"
 #include "xml_namespace.h"
 #include "xml_node.h"
+#include "xml_record_splitter.h"
 #include "xml_sax_parser.h"
+#include "xml_text_reader.h"
 #include "xml_textwriter.h"
+#include "xml_xpath_context.h"
 
 namespace libxmljs {
 
@@ -20,19 +30,46 @@ LibXMLJS LibXMLJS::instance;
 // Store the global environment for memory adjustments
 napi_env globalEnv = nullptr;
 
-// track how much memory libxml2 is using
-int xml_memory_used = 0;
+// track how much memory libxml2 is using, as last reported to V8
+int64_t xml_memory_used = 0;
+
+// use libxml2's debug allocator instead of the counting allocator,
+// selected at load time through the LIBXMLJS_DEBUG_MEMORY environment variable
+bool memory_debug = false;
+
+// bytes currently handed out to libxml2 by the counting allocator
+std::atomic<size_t> xml_memory_counted{0};
+
+// every counted block is prefixed with its size, keeping malloc's alignment
+const size_t counted_header_size = alignof(std::max_align_t);
 
 // How often we report memory usage changes back to V8.
 const int napi_adjust_external_memory_threshold = 1024 * 1024;
 
 // track how many nodes haven't been freed
-int nodeCount = 0;
+// nodes are also created and freed by async workers on the threadpool
+std::atomic<int> nodeCount{0};
+
+// V8 may only be informed about memory changes from the JS thread,
+// allocations made by async workers are picked up by the next report
+thread_local bool isJsThread = false;
+
+int64_t currentMemoryUsage() {
+  if (memory_debug) {
+    return xmlMemUsed();
+  }
+  return static_cast<int64_t>(
+      xml_memory_counted.load(std::memory_order_relaxed));
+}
 
 void adjustExternalMemory() {
-  const int diff = xmlMemUsed() - xml_memory_used;
+  if (!isJsThread) {
+    return;
+  }
+
+  const int64_t diff = currentMemoryUsage() - xml_memory_used;
 
-  if (abs(diff) > napi_adjust_external_memory_threshold) {
+  if (std::abs(diff) > napi_adjust_external_memory_threshold) {
     xml_memory_used += diff;
     if (globalEnv != nullptr) {
       napi_adjust_external_memory(globalEnv, diff, nullptr);
@@ -97,6 +134,129 @@ char *xmlMemoryStrdupWrap(const char *str) {
   return res;
 }
 
+const size_t Utf8Scratch::max_size = 1024 * 1024;
+thread_local std::vector<char> Utf8Scratch::buffer_;
+thread_local bool Utf8Scratch::in_use_ = false;
+
+Utf8Scratch::Utf8Scratch(Napi::String str)
+    : data_(NULL), length_(0), borrowed_(!in_use_) {
+  napi_env env = str.Env();
+  if (borrowed_) {
+    napi_status status =
+        napi_get_value_string_utf8(env, str, NULL, 0, &length_);
+    NAPI_THROW_IF_FAILED_VOID(env, status);
+    borrowed_ = length_ < max_size;
+  }
+
+  if (!borrowed_) {
+    owned_ = str.Utf8Value();
+    data_ = owned_.c_str();
+    length_ = owned_.length();
+    return;
+  }
+
+  // the buffer lives as long as the thread, V8 is told about it as it grows
+  if (buffer_.size() < length_ + 1) {
+    const size_t before = buffer_.capacity();
+    buffer_.resize(length_ + 1);
+    napi_adjust_external_memory(
+        env, static_cast<int64_t>(buffer_.capacity() - before), NULL);
+  }
+
+  napi_status status = napi_get_value_string_utf8(
+      env, str, buffer_.data(), length_ + 1, &length_);
+  NAPI_THROW_IF_FAILED_VOID(env, status);
+
+  in_use_ = true;
+  data_ = buffer_.data();
+}
+
+Utf8Scratch::~Utf8Scratch() {
+  if (borrowed_ && data_ != NULL) {
+    in_use_ = false;
+  }
+}
+
+// Production allocator: plain malloc plus an atomic byte counter. Unlike
+// xmlMemMalloc there is no global lock, and the V8 report only needs the
+// counter, so the per-allocation cost stays at a malloc and an atomic add.
+void *xmlCountingMalloc(size_t size) {
+  if (size > SIZE_MAX - counted_header_size) {
+    return NULL;
+  }
+
+  void *block = malloc(size + counted_header_size);
+  if (!block) {
+    return NULL;
+  }
+
+  *static_cast<size_t *>(block) = size;
+  xml_memory_counted.fetch_add(size, std::memory_order_relaxed);
+  adjustExternalMemory();
+
+  return static_cast<char *>(block) + counted_header_size;
+}
+
+void xmlCountingFree(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  void *block = static_cast<char *>(ptr) - counted_header_size;
+  xml_memory_counted.fetch_sub(*static_cast<size_t *>(block),
+                               std::memory_order_relaxed);
+  free(block);
+
+  // see xmlMemFreeWrap
+  if (globalEnv == nullptr) {
+    return;
+  }
+
+  adjustExternalMemory();
+}
+
+void *xmlCountingRealloc(void *ptr, size_t size) {
+  if (!ptr) {
+    return xmlCountingMalloc(size);
+  }
+
+  if (size > SIZE_MAX - counted_header_size) {
+    return NULL;
+  }
+
+  void *block = static_cast<char *>(ptr) - counted_header_size;
+  const size_t old_size = *static_cast<size_t *>(block);
+
+  block = realloc(block, size + counted_header_size);
+  if (!block) {
+    return NULL;
+  }
+
+  *static_cast<size_t *>(block) = size;
+  xml_memory_counted.fetch_add(size, std::memory_order_relaxed);
+  xml_memory_counted.fetch_sub(old_size, std::memory_order_relaxed);
+  adjustExternalMemory();
+
+  return static_cast<char *>(block) + counted_header_size;
+}
+
+char *xmlCountingStrdup(const char *str) {
+  // like xmlMemStrdup
+  if (str == NULL) {
+    return NULL;
+  }
+
+  const size_t size = strlen(str) + 1;
+  char *res = static_cast<char *>(xmlCountingMalloc(size));
+
+  if (!res) {
+    return res;
+  }
+
+  memcpy(res, str, size);
+  return res;
+}
+
 void deregisterNsList(xmlNs *ns) {
   while (ns != NULL) {
     if (ns->_private != NULL) {
@@ -144,8 +304,12 @@ void xmlRegisterNodeCallback(xmlNode *xml_obj) { nodeCount++; }
 void xmlDeregisterNodeCallback(xmlNode *xml_obj) {
   nodeCount--;
   deregisterNodeNamespaces(xml_obj);
+  XmlDetachedTrees::freed(xml_obj);
+  XmlCursor::freed(xml_obj);
   if (xml_obj->_private != NULL) {
-    static_cast<XmlNodeInstance *>(xml_obj->_private)->xml_obj = NULL;
+    XmlNodeInstance *node = static_cast<XmlNodeInstance *>(xml_obj->_private);
+    node->release_document();
+    node->xml_obj = NULL;
     xml_obj->_private = NULL;
   }
   return;
@@ -158,16 +322,31 @@ LibXMLJS::LibXMLJS() {
   // set the callback for when a node is about to be freed
   xmlDeregisterNodeDefault(xmlDeregisterNodeCallback);
 
-  // populated debugMemSize (see xmlmemory.h/c) and makes the call to
-  // xmlMemUsed work, this must happen first!
-  xmlMemSetup(xmlMemFreeWrap, xmlMemMallocWrap, xmlMemReallocWrap,
-              xmlMemoryStrdupWrap);
+  // the above are thread local, make sure threadpool workers get them too
+  xmlThrDefRegisterNodeDefault(xmlRegisterNodeCallback);
+  xmlThrDefDeregisterNodeDefault(xmlDeregisterNodeCallback);
+
+  // the allocator has to be installed before libxml allocates anything,
+  // this must happen first!
+  const char *debug_memory = getenv("LIBXMLJS_DEBUG_MEMORY");
+  memory_debug = debug_memory != NULL && *debug_memory != '\0' &&
+                 strcmp(debug_memory, "0") != 0;
+
+  if (memory_debug) {
+    // populated debugMemSize (see xmlmemory.h/c) and makes the call to
+    // xmlMemUsed work
+    xmlMemSetup(xmlMemFreeWrap, xmlMemMallocWrap, xmlMemReallocWrap,
+                xmlMemoryStrdupWrap);
+  } else {
+    xmlMemSetup(xmlCountingFree, xmlCountingMalloc, xmlCountingRealloc,
+                xmlCountingStrdup);
+  }
 
   // initialize libxml
   LIBXML_TEST_VERSION;
 
   // initial memory usage
-  xml_memory_used = xmlMemUsed();
+  xml_memory_used = currentMemoryUsage();
 }
 
 LibXMLJS::~LibXMLJS() {}
@@ -214,24 +393,28 @@ Napi::Object listFeatures(Napi::Env env) {
 
 Napi::Value XmlMemUsed(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
-  int memUsed = xmlMemUsed();
-  return Napi::Number::New(env, memUsed);
+  return Napi::Number::New(env, static_cast<double>(currentMemoryUsage()));
 }
 
 Napi::Value XmlNodeCount(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
-  return Napi::Number::New(env, nodeCount);
+  return Napi::Number::New(env, nodeCount.load());
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   // Store the global environment for memory adjustments
   globalEnv = env;
+  isJsThread = true;
 
   SetupXmlNodeInheritance(env, exports);
 
   XmlDocument::Init(env, exports);
   XmlTextWriter::Init(env, exports);
+  XmlTextReader::Init(env, exports);
+  XmlCursor::Init(env, exports);
   XmlSaxParser::Init(env, exports);
+  XmlRecordSplitter::Init(env, exports);
+  XmlXPathExpression::Init(env, exports);
 
   exports.Set("libxml_version", Napi::String::New(env, LIBXML_DOTTED_VERSION));
 
@@ -240,6 +423,8 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
 
   exports.Set("libxml_debug_enabled", Napi::Boolean::New(env, debugging));
 
+  exports.Set("libxml_memory_debug", Napi::Boolean::New(env, memory_debug));
+
   exports.Set("features", listFeatures(env));
 
   exports.Set("libxml", exports);
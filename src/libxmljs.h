@@ -3,6 +3,9 @@
 #define SRC_LIBXMLJS_H_
 
 #include <cassert>
+#include <string>
+#include <vector>
+
 #include <napi.h>
 
 #define LIBXMLJS_ARGUMENT_TYPE_CHECK(arg, type, err)                           \
@@ -36,6 +39,31 @@ static const bool debugging = false;
 // Store the global environment for memory adjustments
 extern napi_env globalEnv;
 
+// UTF-8 copy of a JS string for handing to libxml2. The bytes live in a
+// per-thread buffer that is reused between calls, so parsing a string does not
+// allocate (and fault in) a fresh copy of the whole document every time.
+// Strings above max_size and nested use on the same thread (e.g. parsing
+// from within a SAX callback) fall back to an owned copy.
+class Utf8Scratch {
+public:
+  explicit Utf8Scratch(Napi::String str);
+  ~Utf8Scratch();
+
+  const char *data() const { return data_; }
+  size_t length() const { return length_; }
+
+private:
+  const char *data_;
+  size_t length_;
+  bool borrowed_;
+  std::string owned_;
+
+  // largest string copied into the shared buffer, which is reported to V8
+  static const size_t max_size;
+  static thread_local std::vector<char> buffer_;
+  static thread_local bool in_use_;
+};
+
 // Ensure that libxml is properly initialised and destructed at shutdown
 class LibXMLJS {
 public:
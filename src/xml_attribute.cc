@@ -7,24 +7,12 @@ namespace libxmljs {
 Napi::FunctionReference XmlAttribute::constructor;
 
 XmlAttribute::XmlAttribute(const Napi::CallbackInfo &info) : XmlNode(info) {
-  // if we were created for an existing xml node, then we don't need
-  // to create a new node on the document
-  if (info.Length() != 1 || !info[0].IsExternal()) {
+  // only ever created by NewWrapper() for an existing xml node
+  if (this->xml_obj == NULL) {
     return;
   }
 
-  xmlNode *attr = info[0].As<Napi::External<xmlNode>>().Data();
-
-  this->xml_obj = attr;
-  this->xml_obj->_private = this;
-  this->ancestor = NULL;
-
-  if ((xml_obj->doc != NULL) && (xml_obj->doc->_private != NULL)) {
-    XmlDocument *doc = static_cast<XmlDocument *>(this->xml_obj->doc->_private);
-    this->Value().Set("document", doc->Value());
-  }
-
-  this->ref_wrapped_ancestor();
+  this->wrap_xml_obj();
 }
 
 Napi::Value XmlAttribute::NewInstance(Napi::Env env, xmlNode *xml_obj,
@@ -36,14 +24,13 @@ Napi::Value XmlAttribute::NewInstance(Napi::Env env, xmlNode *xml_obj,
   assert(attr);
 
   if (attr->_private) {
-    auto instance = static_cast<XmlNode *>(xml_obj->_private)->Value();
+    auto instance = static_cast<XmlNode *>(attr->_private)->Value();
     if (!instance.IsEmpty()) {
       return scope.Escape(instance);
     }
   }
 
-  auto external = Napi::External<xmlAttr>::New(env, attr);
-  Napi::Object obj = constructor.New({external});
+  Napi::Object obj = NewWrapper(reinterpret_cast<xmlNode *>(attr));
   return scope.Escape(obj);
 }
 
@@ -58,8 +45,7 @@ Napi::Value XmlAttribute::NewInstance(Napi::Env env, xmlAttr *attr) {
     }
   }
 
-  auto external = Napi::External<xmlAttr>::New(env, attr);
-  Napi::Object obj = constructor.New({external});
+  Napi::Object obj = NewWrapper(reinterpret_cast<xmlNode *>(attr));
   return scope.Escape(obj);
 }
 
@@ -180,6 +166,8 @@ Napi::Function XmlAttribute::Init(Napi::Env env, Napi::Object exports) {
                       InstanceMethod("toString", &XmlNode::ToString),
                       InstanceMethod("remove", &XmlNode::Remove),
                       InstanceMethod("clone", &XmlNode::Clone),
+                      InstanceAccessor("document", &XmlNode::GetDocument,
+                                       nullptr),
                   });
 
   constructor = Napi::Persistent(ctor);
@@ -17,42 +17,30 @@ XmlComment::XmlComment(const Napi::CallbackInfo &info) : XmlNode(info) {
 
   // if we were created for an existing xml node, then we don't need
   // to create a new node on the document
-  xmlNode *comm;
-
-  if (info.Length() == 1 && info[0].IsExternal()) {
-    // Unwrap the external to get the xmlNode pointer
-    comm = info[0].As<Napi::External<xmlNode>>().Data();
-  } else {
-    DOCUMENT_ARG_CHECK;
-
-    Napi::Object docObj = info[0].ToObject();
-    XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(docObj);
-    if (document == nullptr) {
-      Napi::Error::New(env, "Invalid document argument")
-          .ThrowAsJavaScriptException();
-      return;
-    }
+  if (this->xml_obj != NULL) {
+    this->wrap_xml_obj();
+    return;
+  }
 
-    const char *content = nullptr;
-    std::string contentStr;
-    if (info.Length() > 1 && info[1].IsString()) {
-      contentStr = info[1].As<Napi::String>().Utf8Value();
-      content = contentStr.c_str();
-    }
+  DOCUMENT_ARG_CHECK;
 
-    comm = xmlNewDocComment(document->xml_obj, (xmlChar *)content);
+  Napi::Object docObj = info[0].ToObject();
+  XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(docObj);
+  if (document == nullptr) {
+    Napi::Error::New(env, "Invalid document argument")
+        .ThrowAsJavaScriptException();
+    return;
   }
 
-  this->xml_obj = comm;
-  this->xml_obj->_private = this;
-  this->ancestor = NULL;
-
-  if ((xml_obj->doc != NULL) && (xml_obj->doc->_private != NULL)) {
-    XmlDocument *doc = static_cast<XmlDocument *>(this->xml_obj->doc->_private);
-    this->Value().Set("document", doc->Value());
+  const char *content = nullptr;
+  std::string contentStr;
+  if (info.Length() > 1 && info[1].IsString()) {
+    contentStr = info[1].As<Napi::String>().Utf8Value();
+    content = contentStr.c_str();
   }
 
-  this->ref_wrapped_ancestor();
+  this->xml_obj = xmlNewDocComment(document->xml_obj, (xmlChar *)content);
+  this->wrap_xml_obj();
 }
 
 Napi::Value XmlComment::Text(const Napi::CallbackInfo &info) {
@@ -94,9 +82,7 @@ Napi::Value XmlComment::NewInstance(Napi::Env env, xmlNode *node) {
     }
   }
 
-  Napi::Function cons = constructor.Value();
-  auto external = Napi::External<xmlNode>::New(env, node);
-  Napi::Object instance = cons.New({external});
+  Napi::Object instance = XmlComment::NewWrapper(node);
 
   return scope.Escape(instance);
 }
@@ -118,6 +104,8 @@ Napi::Function XmlComment::Init(Napi::Env env, Napi::Object exports) {
                       InstanceMethod("toString", &XmlNode::ToString),
                       InstanceMethod("remove", &XmlNode::Remove),
                       InstanceMethod("clone", &XmlNode::Clone),
+                      InstanceAccessor("document", &XmlNode::GetDocument,
+                                       nullptr),
                   });
 
   constructor = Napi::Persistent(func);
@@ -0,0 +1,304 @@
+// Copyright 2009, Squish Tech, LLC.
+
+#include <unordered_map>
+#include <vector>
+
+#include "xml_cursor.h"
+#include "xml_document.h"
+#include "xml_element.h"
+#include "xml_node.h"
+
+namespace libxmljs {
+
+Napi::FunctionReference XmlCursor::constructor;
+
+// live cursors by the node they started at and the node they are on, to
+// invalidate them when libxml frees either
+static thread_local std::unordered_multimap<xmlNode *, XmlCursor *>
+    cursor_nodes;
+
+static void track_cursor(xmlNode *node, XmlCursor *cursor) {
+  if (node != NULL) {
+    cursor_nodes.emplace(node, cursor);
+  }
+}
+
+static void untrack_cursor(xmlNode *node, XmlCursor *cursor) {
+  if (node == NULL) {
+    return;
+  }
+  auto range = cursor_nodes.equal_range(node);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == cursor) {
+      cursor_nodes.erase(it);
+      return;
+    }
+  }
+}
+
+// JS-signature: (node: Document | Element)
+XmlCursor::XmlCursor(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlCursor>(info), start(NULL), current(NULL),
+      depth(0) {
+  Napi::Env env = info.Env();
+
+  Napi::Object node = info.Length() > 0 && info[0].IsObject()
+                          ? info[0].ToObject()
+                          : Napi::Object();
+  if (!node.IsEmpty() && node.InstanceOf(XmlDocument::constructor.Value())) {
+    XmlDocument *document = XmlDocument::Unwrap(node);
+    start = xmlDocGetRootElement(document->xml_obj);
+    if (start == NULL) {
+      Napi::Error::New(env, "document has no root element")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+  } else if (!node.IsEmpty() &&
+             node.InstanceOf(XmlElement::constructor.Value())) {
+    start = XmlElement::Unwrap(node)->xml_obj;
+  } else {
+    Napi::TypeError::New(env,
+                         "Bad Argument: Cursor requires a Document or Element")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  owner = Napi::Persistent(node);
+  track_cursor(start, this);
+  move_to(start);
+}
+
+XmlCursor::~XmlCursor() {
+  untrack_cursor(start, this);
+  untrack_cursor(current, this);
+}
+
+void XmlCursor::move_to(xmlNode *node) {
+  untrack_cursor(current, this);
+  current = node;
+  track_cursor(current, this);
+}
+
+void XmlCursor::freed(xmlNode *xml_obj) {
+  if (cursor_nodes.empty()) {
+    return;
+  }
+
+  auto range = cursor_nodes.equal_range(xml_obj);
+  if (range.first == range.second) {
+    return;
+  }
+
+  std::vector<XmlCursor *> hit;
+  for (auto it = range.first; it != range.second; ++it) {
+    hit.push_back(it->second);
+  }
+  cursor_nodes.erase(range.first, range.second);
+
+  for (XmlCursor *cursor : hit) {
+    if (cursor->start == xml_obj) {
+      cursor->start = NULL;
+      if (cursor->current != xml_obj) {
+        untrack_cursor(cursor->current, cursor);
+      }
+      cursor->current = NULL;
+    } else if (cursor->current == xml_obj) {
+      cursor->current = NULL;
+    }
+  }
+}
+
+bool XmlCursor::check_node(Napi::Env env) {
+  if (current == NULL) {
+    Napi::Error::New(env, "the node under the cursor was freed")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
+
+// string of the content of a node, without copying it where libxml keeps
+// it in one piece
+static Napi::Value node_content(Napi::Env env, xmlNode *node) {
+  xmlNode *text = node;
+  if ((node->type == XML_ELEMENT_NODE) ||
+      (node->type == XML_ATTRIBUTE_NODE)) {
+    text = node->children;
+    if (text == NULL) {
+      return Napi::String::New(env, "");
+    }
+    if ((text->next != NULL) || ((text->type != XML_TEXT_NODE) &&
+                                 (text->type != XML_CDATA_SECTION_NODE))) {
+      text = NULL;
+    }
+  } else if ((node->type != XML_TEXT_NODE) &&
+             (node->type != XML_CDATA_SECTION_NODE) &&
+             (node->type != XML_COMMENT_NODE) &&
+             (node->type != XML_PI_NODE)) {
+    text = NULL;
+  }
+
+  if (text != NULL) {
+    const char *content = (const char *)text->content;
+    return Napi::String::New(env, content != NULL ? content : "");
+  }
+
+  xmlChar *content = xmlNodeGetContent(node);
+  if (content == NULL) {
+    return Napi::String::New(env, "");
+  }
+  Napi::String ret = Napi::String::New(env, (const char *)content);
+  xmlFree(content);
+  return ret;
+}
+
+Napi::Value XmlCursor::FirstChild(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+
+  // the children of an entity reference are the entity declaration
+  if ((current->children == NULL) ||
+      (current->type == XML_ENTITY_REF_NODE)) {
+    return Napi::Boolean::New(env, false);
+  }
+
+  move_to(current->children);
+  depth++;
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value XmlCursor::Next(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+
+  if ((current == start) || (current->next == NULL)) {
+    return Napi::Boolean::New(env, false);
+  }
+
+  move_to(current->next);
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value XmlCursor::Parent(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+
+  // also stops on a node that was moved out from below start
+  if ((current == start) || (current->parent == NULL) || (depth == 0)) {
+    return Napi::Boolean::New(env, false);
+  }
+
+  move_to(current->parent);
+  depth--;
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value XmlCursor::Type(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+
+  const char *name = get_node_type_name(current->type);
+  if (name == NULL) {
+    return env.Null();
+  }
+  return Napi::String::New(env, name);
+}
+
+Napi::Value XmlCursor::Name(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+
+  if (current->name == NULL) {
+    return env.Null();
+  }
+  return Napi::String::New(env, (const char *)current->name);
+}
+
+Napi::Value XmlCursor::Text(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+  return node_content(env, current);
+}
+
+// JS-signature: (name: string)
+Napi::Value XmlCursor::Attr(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+
+  if (info.Length() == 0 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Bad Argument: attribute name must be a string")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  if (current->type != XML_ELEMENT_NODE) {
+    return env.Null();
+  }
+
+  std::string name = info[0].As<Napi::String>().Utf8Value();
+  xmlAttr *attr = xmlHasProp(current, (const xmlChar *)name.c_str());
+  if ((attr == NULL) || (attr->type != XML_ATTRIBUTE_NODE)) {
+    return env.Null();
+  }
+  return node_content(env, reinterpret_cast<xmlNode *>(attr));
+}
+
+Napi::Value XmlCursor::Depth(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_node(env)) {
+    return env.Undefined();
+  }
+  return Napi::Number::New(env, static_cast<double>(depth));
+}
+
+// move back to the node the cursor started at
+Napi::Value XmlCursor::Reset(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (start == NULL) {
+    Napi::Error::New(env, "the node under the cursor was freed")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  move_to(start);
+  depth = 0;
+  return env.Undefined();
+}
+
+void XmlCursor::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func =
+      DefineClass(env, "Cursor",
+                  {
+                      InstanceMethod("firstChild", &XmlCursor::FirstChild),
+                      InstanceMethod("next", &XmlCursor::Next),
+                      InstanceMethod("parent", &XmlCursor::Parent),
+                      InstanceMethod("type", &XmlCursor::Type),
+                      InstanceMethod("name", &XmlCursor::Name),
+                      InstanceMethod("text", &XmlCursor::Text),
+                      InstanceMethod("attr", &XmlCursor::Attr),
+                      InstanceMethod("depth", &XmlCursor::Depth),
+                      InstanceMethod("reset", &XmlCursor::Reset),
+                  });
+
+  constructor = Napi::Persistent(func);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("Cursor", func);
+}
+
+} // namespace libxmljs
@@ -0,0 +1,57 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_CURSOR_H_
+#define SRC_XML_CURSOR_H_
+
+#include <libxml/tree.h>
+
+#include "libxmljs.h"
+
+namespace libxmljs {
+
+// Read-only walk over a subtree that moves a position around instead of
+// creating a wrapper for every node it visits. The cursor stays within the
+// subtree of the node it was created for.
+class XmlCursor : public Napi::ObjectWrap<XmlCursor> {
+public:
+  explicit XmlCursor(const Napi::CallbackInfo &info);
+  ~XmlCursor();
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  // libxml is about to free xml_obj, cursors on it are invalidated
+  static void freed(xmlNode *xml_obj);
+
+private:
+  Napi::Value FirstChild(const Napi::CallbackInfo &info);
+  Napi::Value Next(const Napi::CallbackInfo &info);
+  Napi::Value Parent(const Napi::CallbackInfo &info);
+  Napi::Value Type(const Napi::CallbackInfo &info);
+  Napi::Value Name(const Napi::CallbackInfo &info);
+  Napi::Value Text(const Napi::CallbackInfo &info);
+  Napi::Value Attr(const Napi::CallbackInfo &info);
+  Napi::Value Depth(const Napi::CallbackInfo &info);
+  Napi::Value Reset(const Napi::CallbackInfo &info);
+
+  // throws if the node under the cursor was freed
+  bool check_node(Napi::Env env);
+
+  // move the cursor to node, keeping the index of cursors by node current
+  void move_to(xmlNode *node);
+
+  // node the cursor started at, it does not move above it
+  xmlNode *start;
+
+  // node the cursor is on, NULL once it was freed
+  xmlNode *current;
+
+  // levels below start
+  size_t depth;
+
+  // the document or element the cursor was created for, keeps start alive
+  Napi::ObjectReference owner;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_CURSOR_H_
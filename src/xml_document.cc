@@ -1,11 +1,14 @@
 // Copyright 2009, Squish Tech, LLC.
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <limits>
 
 // #include <libxml/tree.h>
 #include <libxml/HTMLparser.h>
 #include <libxml/HTMLtree.h>
+#include <libxml/parserInternals.h>
 #include <libxml/relaxng.h>
 #include <libxml/schematron.h>
 #include <libxml/xinclude.h>
@@ -17,7 +20,11 @@
 #include "xml_element.h"
 #include "xml_namespace.h"
 #include "xml_node.h"
+#include "xml_parse_worker.h"
+#include "xml_parser_pool.h"
+#include "xml_schema.h"
 #include "xml_syntax_error.h"
+#include "xml_validate_worker.h"
 
 namespace libxmljs {
 
@@ -25,7 +32,7 @@ Napi::FunctionReference XmlDocument::constructor;
 
 // JS-signature: (version?: string, encoding?: string)
 XmlDocument::XmlDocument(const Napi::CallbackInfo &info)
-    : Napi::ObjectWrap<XmlDocument>(info) {
+    : Napi::ObjectWrap<XmlDocument>(info), errors_pending_(false) {
 
   if (info.Length() > 0 && info[0].IsExternal()) {
     xml_obj = info[0].As<Napi::External<xmlDoc>>().Data();
@@ -48,6 +55,7 @@ XmlDocument::XmlDocument(const Napi::CallbackInfo &info)
 
 XmlDocument::~XmlDocument() {
   this->xml_obj->_private = NULL;
+  XmlDetachedTrees::free_document(this->xml_obj);
   xmlFreeDoc(this->xml_obj);
 }
 
@@ -114,8 +122,10 @@ Napi::Value XmlDocument::Root(const Napi::CallbackInfo &info) {
   // set the element as the root element for the document
   // allows for proper retrieval of root later
   XmlElement *element = XmlElement::Unwrap(info[0].ToObject());
+  xmlNode *parent = element->xml_obj->parent;
   xmlDocSetRootElement(this->xml_obj, element->xml_obj);
-  element->ref_wrapped_ancestor();
+  XmlDetachedTrees::unlinked(element->xml_obj, parent);
+  XmlDetachedTrees::linked(element->xml_obj);
   return scope.Escape(info[0]);
 }
 
@@ -280,6 +290,36 @@ Napi::Value XmlDocument::Type(const Napi::CallbackInfo &info) {
 
 // not called from node
 // private api
+void XmlDocument::set_parse_errors(std::vector<XmlErrorRecord> records) {
+  parse_errors_ = std::move(records);
+  errors_pending_ = true;
+  errors_.Reset();
+}
+
+Napi::Value XmlDocument::GetErrors(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (errors_pending_) {
+    errors_ = Napi::Reference<Napi::Value>::New(
+        XmlSyntaxError::BuildSyntaxErrors(env, parse_errors_), 1);
+    parse_errors_.clear();
+    parse_errors_.shrink_to_fit();
+    errors_pending_ = false;
+  }
+
+  if (errors_.IsEmpty()) {
+    return env.Undefined();
+  }
+  return errors_.Value();
+}
+
+void XmlDocument::SetErrors(const Napi::CallbackInfo &info,
+                            const Napi::Value &value) {
+  parse_errors_.clear();
+  errors_pending_ = false;
+  errors_ = Napi::Reference<Napi::Value>::New(value, 1);
+}
+
 Napi::Value XmlDocument::NewInstance(Napi::Env env, xmlDoc *doc) {
   Napi::EscapableHandleScope scope(env);
 
@@ -423,57 +463,228 @@ xmlParserOption getParserOptions(Napi::Object props) {
   return (xmlParserOption)ret;
 }
 
-Napi::Value XmlDocument::FromHtml(const Napi::CallbackInfo &info) {
+size_t getMaxErrors(Napi::Object props) {
+  Napi::Value value = props.Get("maxErrors");
+  if (!value.IsNumber() || value.As<Napi::Number>().DoubleValue() < 0) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return (size_t)value.As<Napi::Number>().DoubleValue();
+}
+
+XmlParseOptions XmlParseOptions::Read(Napi::Object props) {
+  if (props.InstanceOf(XmlParserOptions::constructor.Value())) {
+    return XmlParserOptions::Unwrap(props)->options;
+  }
+
+  XmlParseOptions options;
+  options.opts = (int)getParserOptions(props);
+  options.max_errors = getMaxErrors(props);
+
+  if (props.Has("baseUrl") && props.Get("baseUrl").IsString()) {
+    options.base_url = props.Get("baseUrl").ToString().Utf8Value();
+  }
+  if (props.Has("encoding") && props.Get("encoding").IsString()) {
+    options.encoding = props.Get("encoding").ToString().Utf8Value();
+  }
+
+  options.exclude_implied_elements =
+      props.Has("excludeImpliedElements") &&
+      props.Get("excludeImpliedElements").ToBoolean().Value();
+
+  return options;
+}
+
+Napi::FunctionReference XmlParserOptions::constructor;
+
+// JS-signature: (options?: object)
+XmlParserOptions::XmlParserOptions(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlParserOptions>(info) {
   Napi::Env env = info.Env();
-  Napi::EscapableHandleScope scope(env);
 
-  Napi::Object options = info[1].ToObject();
+  if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsObject()) {
+    Napi::TypeError::New(env, "parser options must be an object")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  options = XmlParseOptions::Read(info.Length() > 0 && info[0].IsObject()
+                                      ? info[0].ToObject()
+                                      : Napi::Object::New(env));
+}
+
+void XmlParserOptions::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function ctor = DefineClass(env, "ParserOptions", {});
+
+  constructor = Napi::Persistent(ctor);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("ParserOptions", ctor);
+}
+
+// UTF-16 code units of a string converted per chunk when parsing a large
+// string. At most 768 KiB of UTF-8, so a chunk fits the Utf8Scratch buffer.
+static const size_t STRING_CHUNK_LENGTH = 256 * 1024;
+
+static size_t string_length(Napi::Env env, Napi::String str) {
+  size_t length = 0;
+  napi_status status =
+      napi_get_value_string_utf16(env, str, NULL, 0, &length);
+  NAPI_THROW_IF_FAILED(env, status, 0);
+  return length;
+}
+
+/*
+ * Parse a string longer than STRING_CHUNK_LENGTH with a push parser, fed one
+ * chunk of the string converted to UTF-8 at a time. Unlike converting the
+ * whole string up front, there is never a UTF-8 copy of the document next
+ * to the JS string and the tree. Follows xmlCtxtReadMemory: without
+ * XML_PARSE_RECOVER a document that is not well formed gives NULL.
+ */
+static xmlDoc *parse_string_chunks(Napi::Env env, bool html, Napi::String str,
+                                   size_t length, const char *url,
+                                   const char *encoding, int opts,
+                                   std::optional<XmlErrorRecord> &fatal_error) {
+  xmlParserCtxt *ctxt =
+      html ? htmlCreatePushParserCtxt(NULL, NULL, NULL, 0, url,
+                                      XML_CHAR_ENCODING_NONE)
+           : xmlCreatePushParserCtxt(NULL, NULL, NULL, 0, url);
+  if (ctxt == NULL) {
+    return NULL;
+  }
+  if (html) {
+    htmlCtxtUseOptions(ctxt, opts);
+  } else {
+    xmlCtxtUseOptions(ctxt, opts);
+  }
+  if (encoding != NULL) {
+    xmlCharEncodingHandler *handler = xmlFindCharEncodingHandler(encoding);
+    if (handler != NULL) {
+      xmlSwitchToEncoding(ctxt, handler);
+    }
+  }
+
+  Napi::Object object = str.ToObject();
+  Napi::Function slice = object.Get("slice").As<Napi::Function>();
+  Napi::Function char_code_at = object.Get("charCodeAt").As<Napi::Function>();
+
+  size_t pos = 0;
+  while (pos < length && !env.IsExceptionPending()) {
+    Napi::HandleScope scope(env);
+
+    // never split a surrogate pair
+    size_t end = std::min(pos + STRING_CHUNK_LENGTH, length);
+    if (end < length) {
+      uint32_t unit =
+          char_code_at.Call(str, {Napi::Number::New(env, (double)(end - 1))})
+              .ToNumber()
+              .Uint32Value();
+      if (unit >= 0xD800 && unit <= 0xDBFF) {
+        end--;
+      }
+    }
+
+    Napi::Value piece = slice.Call(str, {Napi::Number::New(env, (double)pos),
+                                         Napi::Number::New(env, (double)end)});
+    Utf8Scratch chunk(piece.As<Napi::String>());
+    if (html) {
+      htmlParseChunk(ctxt, chunk.data(), (int)chunk.length(), 0);
+    } else {
+      xmlParseChunk(ctxt, chunk.data(), (int)chunk.length(), 0);
+    }
+    pos = end;
 
-  // the base URL that will be used for this HTML parsed document
-  const char *baseUrl = NULL;
-  std::string baseUrlStr;
-  if (options.Has("baseUrl") && options.Get("baseUrl").IsString()) {
-    baseUrlStr = options.Get("baseUrl").ToString().Utf8Value();
-    baseUrl = baseUrlStr.c_str();
+    if (ctxt->instate == XML_PARSER_EOF) {
+      break;
+    }
   }
 
-  // the encoding to be used for this document
-  // (leave NULL for libxml to autodetect)
-  const char *encoding = NULL;
-  std::string encodingStr;
-  if (options.Has("encoding") && options.Get("encoding").IsString()) {
-    encodingStr = options.Get("encoding").ToString().Utf8Value();
-    encoding = encodingStr.c_str();
+  if (html) {
+    htmlParseChunk(ctxt, NULL, 0, 1);
+  } else {
+    xmlParseChunk(ctxt, NULL, 0, 1);
   }
 
-  ErrorArrayContext ctx{env, Napi::Array::New(env)};
+  xmlDoc *doc = ctxt->myDoc;
+  ctxt->myDoc = NULL;
+  if ((doc != NULL) && !html && !ctxt->wellFormed &&
+      !(opts & XML_PARSE_RECOVER)) {
+    xmlFreeDoc(doc);
+    doc = NULL;
+  }
+  if (env.IsExceptionPending() && (doc != NULL)) {
+    xmlFreeDoc(doc);
+    doc = NULL;
+  }
+
+  if (doc == NULL) {
+    const xmlError *error = xmlCtxtGetLastError(ctxt);
+    if (error != NULL && error->code != XML_ERR_OK) {
+      fatal_error.emplace(error);
+    }
+  }
+
+  if (html) {
+    htmlFreeParserCtxt(ctxt);
+  } else {
+    xmlFreeParserCtxt(ctxt);
+  }
+  return doc;
+}
+
+Napi::Value XmlDocument::FromHtml(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::EscapableHandleScope scope(env);
+
+  XmlParseOptions options = XmlParseOptions::Read(info[1].ToObject());
+  const char *baseUrl = options.base_url_or_null();
+  const char *encoding = options.encoding_or_null();
+
+  XmlErrorCollector errors(options.max_errors);
 
   xmlResetLastError();
-  xmlSetStructuredErrorFunc(&ctx, XmlSyntaxError::PushToArray);
+  xmlSetStructuredErrorFunc(&errors, XmlSyntaxError::PushToCollector);
 
-  int opts = (int)getParserOptions(options);
-  if (options.Has("excludeImpliedElements") &&
-      options.Get("excludeImpliedElements").ToBoolean().Value()) {
+  // fromHtmlFragment parses without implied elements or doctype
+  int opts = options.opts;
+  if (options.exclude_implied_elements ||
+      (info.Length() > 2 && info[2].ToBoolean().Value())) {
     opts |= HTML_PARSE_NOIMPLIED | HTML_PARSE_NODEFDTD;
   }
 
+  XmlParserPool &pool = XmlParserPool::current();
+  std::optional<XmlErrorRecord> fatal_error;
+
   htmlDocPtr doc;
-  if (!info[0].IsBuffer()) {
+  Napi::String input =
+      info[0].IsBuffer() ? Napi::String() : info[0].ToString();
+  size_t length = input.IsEmpty() ? 0 : string_length(env, input);
+  if (length > STRING_CHUNK_LENGTH) {
+    // Parse a large string chunk by chunk
+    doc = parse_string_chunks(env, true, input, length, baseUrl, encoding, opts,
+                              fatal_error);
+  } else if (!input.IsEmpty()) {
     // Parse a string
-    std::string str = info[0].ToString().Utf8Value();
-    doc = htmlReadMemory(str.c_str(), str.length(), baseUrl, encoding, opts);
+    Utf8Scratch str(input);
+    doc = pool.read_memory(true, str.data(), str.length(), baseUrl, encoding,
+                           opts, fatal_error);
   } else {
     // Parse a buffer
     Napi::Buffer<char> buf = info[0].As<Napi::Buffer<char>>();
-    doc = htmlReadMemory(buf.Data(), buf.Length(), baseUrl, encoding, opts);
+    doc = pool.read_memory(true, buf.Data(), buf.Length(), baseUrl, encoding,
+                           opts, fatal_error);
   }
 
   xmlSetStructuredErrorFunc(NULL, NULL);
 
+  if (env.IsExceptionPending()) {
+    return scope.Escape(env.Undefined());
+  }
+
   if (!doc) {
-    const xmlError *error = xmlGetLastError();
-    if (error) {
-      XmlSyntaxError::BuildSyntaxError(env, error).ThrowAsJavaScriptException();
+    if (fatal_error) {
+      XmlSyntaxError::BuildSyntaxError(env, *fatal_error)
+          .ThrowAsJavaScriptException();
       return scope.Escape(env.Undefined());
     }
     Napi::Error::New(env, "Could not parse XML string")
@@ -482,7 +693,7 @@ Napi::Value XmlDocument::FromHtml(const Napi::CallbackInfo &info) {
   }
 
   Napi::Object doc_handle = XmlDocument::NewInstance(env, doc).ToObject();
-  doc_handle.Set("errors", ctx.errors);
+  XmlDocument::Unwrap(doc_handle)->set_parse_errors(std::move(errors.records));
 
   // create the xml document handle to return
   return scope.Escape(doc_handle);
@@ -494,49 +705,49 @@ Napi::Value XmlDocument::FromHtml(const Napi::CallbackInfo &info) {
 Napi::Value XmlDocument::FromXml(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
   Napi::EscapableHandleScope scope(env);
-  Napi::Array errors = Napi::Array::New(env);
+  XmlParseOptions options = XmlParseOptions::Read(info[1].ToObject());
+  const char *baseUrl = options.base_url_or_null();
+  const char *encoding = options.encoding_or_null();
+  int opts = options.opts;
 
-  ErrorArrayContext ctx{env, errors};
+  XmlErrorCollector errors(options.max_errors);
 
   xmlResetLastError();
-  xmlSetStructuredErrorFunc(&ctx, XmlSyntaxError::PushToArray);
-  Napi::Object options = info[1].ToObject();
-
-  // the base URL that will be used for this document
-  const char *baseUrl = NULL;
-  std::string baseUrlStr;
-  if (options.Has("baseUrl") && options.Get("baseUrl").IsString()) {
-    baseUrlStr = options.Get("baseUrl").ToString().Utf8Value();
-    baseUrl = baseUrlStr.c_str();
-  }
+  xmlSetStructuredErrorFunc(&errors, XmlSyntaxError::PushToCollector);
 
-  // the encoding to be used for this document
-  // (leave NULL for libxml to autodetect)
-  const char *encoding = NULL;
-  std::string encodingStr;
-  if (options.Has("encoding") && options.Get("encoding").IsString()) {
-    encodingStr = options.Get("encoding").ToString().Utf8Value();
-    encoding = encodingStr.c_str();
-  }
+  XmlParserPool &pool = XmlParserPool::current();
+  std::optional<XmlErrorRecord> fatal_error;
 
-  int opts = (int)getParserOptions(options);
   xmlDoc *doc;
-  if (!info[0].IsBuffer()) {
+  Napi::String input =
+      info[0].IsBuffer() ? Napi::String() : info[0].ToString();
+  size_t length = input.IsEmpty() ? 0 : string_length(env, input);
+  if (length > STRING_CHUNK_LENGTH) {
+    // Parse a large string chunk by chunk
+    doc = parse_string_chunks(env, false, input, length, baseUrl, encoding, opts,
+                              fatal_error);
+  } else if (!input.IsEmpty()) {
     // Parse a string
-    std::string str = info[0].ToString().Utf8Value();
-    doc = xmlReadMemory(str.c_str(), str.length(), baseUrl, encoding, opts);
+    Utf8Scratch str(input);
+    doc = pool.read_memory(false, str.data(), str.length(), baseUrl, encoding,
+                           opts, fatal_error);
   } else {
     // Parse a buffer
     Napi::Buffer<char> buf = info[0].As<Napi::Buffer<char>>();
-    doc = xmlReadMemory(buf.Data(), buf.Length(), baseUrl, encoding, opts);
+    doc = pool.read_memory(false, buf.Data(), buf.Length(), baseUrl, encoding,
+                           opts, fatal_error);
   }
 
   xmlSetStructuredErrorFunc(NULL, NULL);
 
+  if (env.IsExceptionPending()) {
+    return scope.Escape(env.Undefined());
+  }
+
   if (!doc) {
-    const xmlError *error = xmlGetLastError();
-    if (error) {
-      XmlSyntaxError::BuildSyntaxError(env, error).ThrowAsJavaScriptException();
+    if (fatal_error) {
+      XmlSyntaxError::BuildSyntaxError(env, *fatal_error)
+          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
     Napi::Error::New(env, "Could not parse XML string")
@@ -545,7 +756,7 @@ Napi::Value XmlDocument::FromXml(const Napi::CallbackInfo &info) {
   }
 
   if (opts & XML_PARSE_XINCLUDE) {
-    xmlSetStructuredErrorFunc(&ctx, XmlSyntaxError::PushToArray);
+    xmlSetStructuredErrorFunc(&errors, XmlSyntaxError::PushToCollector);
     int ret = xmlXIncludeProcessFlags(doc, opts);
     xmlSetStructuredErrorFunc(NULL, NULL);
 
@@ -564,7 +775,7 @@ Napi::Value XmlDocument::FromXml(const Napi::CallbackInfo &info) {
 
   Napi::Value x = XmlDocument::NewInstance(env, doc);
   Napi::Object doc_handle = x.ToObject();
-  doc_handle.Set("errors", ctx.errors);
+  XmlDocument::Unwrap(doc_handle)->set_parse_errors(std::move(errors.records));
 
   xmlNode *root_node = xmlDocGetRootElement(doc);
   if (root_node == NULL) {
@@ -577,42 +788,97 @@ Napi::Value XmlDocument::FromXml(const Napi::CallbackInfo &info) {
   return scope.Escape(doc_handle);
 }
 
-Napi::Value XmlDocument::Validate(const Napi::CallbackInfo &info) {
+Napi::Value XmlDocument::ParserPoolStats(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
-  Napi::EscapableHandleScope scope(env);
+  XmlParserPool &pool = XmlParserPool::current();
 
-  if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
-    Napi::Error::New(env, "Must pass xsd").ThrowAsJavaScriptException();
-    return scope.Escape(env.Undefined());
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("hits", Napi::Number::New(env, pool.hits));
+  stats.Set("misses", Napi::Number::New(env, pool.misses));
+  stats.Set("size", Napi::Number::New(env, pool.size()));
+  stats.Set("capacity", Napi::Number::New(env, pool.capacity));
+
+  return stats;
+}
+
+Napi::Value XmlDocument::SetParserPoolSize(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber() ||
+      info[0].As<Napi::Number>().Int64Value() < 0) {
+    Napi::TypeError::New(env, "pool size must be a non-negative number")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
   }
-  if (!info[0].IsObject() ||
-      !info[0].ToObject().InstanceOf(XmlDocument::constructor.Value())) {
-    Napi::Error::New(env, "Must pass XmlDocument").ThrowAsJavaScriptException();
-    return scope.Escape(env.Undefined());
+
+  XmlParserPool::current().set_capacity(
+      static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+
+  return env.Undefined();
+}
+
+// options of the async parse functions: null or undefined mean none instead
+// of throwing before there is a promise to reject
+static Napi::Object async_parse_options(Napi::Env env, Napi::Value value) {
+  if (value.IsNull() || value.IsUndefined()) {
+    return Napi::Object::New(env);
   }
+  return value.ToObject();
+}
 
-  Napi::Array errors = Napi::Array::New(env);
-  ErrorArrayContext ctx{env, errors};
+Napi::Value XmlDocument::FromHtmlAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
 
-  xmlResetLastError();
-  xmlSetStructuredErrorFunc(&ctx, XmlSyntaxError::PushToArray);
+  XmlParseWorker *worker =
+      new XmlParseWorker(env, XmlParseWorker::HTML, info[0],
+                         async_parse_options(env, info[1]));
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
 
-  XmlDocument *documentSchema =
-      Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+  return promise;
+}
 
-  xmlSchemaParserCtxtPtr parser_ctxt =
-      xmlSchemaNewDocParserCtxt(documentSchema->xml_obj);
-  if (parser_ctxt == NULL) {
-    Napi::Error::New(env, "Could not create context for schema parser")
-        .ThrowAsJavaScriptException();
+Napi::Value XmlDocument::FromXmlAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  XmlParseWorker *worker =
+      new XmlParseWorker(env, XmlParseWorker::XML, info[0],
+                         async_parse_options(env, info[1]));
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+
+  return promise;
+}
+
+Napi::Value XmlDocument::Validate(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::EscapableHandleScope scope(env);
+
+  if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
+    Napi::Error::New(env, "Must pass xsd").ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
-  xmlSchemaPtr schema = xmlSchemaParse(parser_ctxt);
-  if (schema == NULL) {
-    Napi::Error::New(env, "Invalid XSD schema").ThrowAsJavaScriptException();
+
+  // a precompiled Schema is used as is, a schema document is compiled
+  // for this call only
+  XmlSchemaCompiledPtr compiled;
+  if (info[0].IsObject() &&
+      info[0].ToObject().InstanceOf(XmlSchema::constructor.Value())) {
+    compiled = XmlSchema::Unwrap(info[0].ToObject())->compiled;
+  } else if (info[0].IsObject() &&
+             info[0].ToObject().InstanceOf(XmlDocument::constructor.Value())) {
+    XmlDocument *documentSchema =
+        Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+    compiled = XmlSchema::Compile(env, documentSchema->xml_obj, false);
+    if (!compiled) {
+      return scope.Escape(env.Undefined());
+    }
+  } else {
+    Napi::Error::New(env, "Must pass XmlDocument").ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
-  xmlSchemaValidCtxtPtr valid_ctxt = xmlSchemaNewValidCtxt(schema);
+
+  xmlSchemaValidCtxtPtr valid_ctxt = xmlSchemaNewValidCtxt(compiled->schema);
   if (valid_ctxt == NULL) {
     Napi::Error::New(env,
                      "Unable to create a validation context for the schema")
@@ -620,73 +886,110 @@ Napi::Value XmlDocument::Validate(const Napi::CallbackInfo &info) {
     return scope.Escape(env.Undefined());
   }
 
-  bool valid = xmlSchemaValidateDoc(valid_ctxt, xml_obj) == 0;
+  Napi::Array errors = Napi::Array::New(env);
+  ErrorArrayContext ctx{env, errors};
 
-  xmlSetStructuredErrorFunc(NULL, NULL);
-  this->Value().Set("validationErrors", errors);
+  xmlResetLastError();
+  xmlSchemaSetValidStructuredErrors(valid_ctxt, XmlSyntaxError::PushToArray,
+                                    &ctx);
+
+  bool valid = xmlSchemaValidateDoc(valid_ctxt, xml_obj) == 0;
 
   xmlSchemaFreeValidCtxt(valid_ctxt);
-  xmlSchemaFree(schema);
-  xmlSchemaFreeParserCtxt(parser_ctxt);
+  this->Value().Set("validationErrors", errors);
 
   return scope.Escape(Napi::Boolean::New(env, valid));
 }
 
-Napi::Value XmlDocument::RngValidate(const Napi::CallbackInfo &info) {
+Napi::Value XmlDocument::ValidateAsync(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
-  Napi::EscapableHandleScope scope(env);
 
   if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
     Napi::Error::New(env, "Must pass xsd").ThrowAsJavaScriptException();
-    return scope.Escape(env.Undefined());
+    return env.Undefined();
   }
 
-  if (!info[0].IsObject() ||
-      !info[0].ToObject().InstanceOf(constructor.Value())) {
+  // the worker may outlive a schema document, so compile from a copy
+  XmlSchemaCompiledPtr compiled;
+  if (info[0].IsObject() &&
+      info[0].ToObject().InstanceOf(XmlSchema::constructor.Value())) {
+    compiled = XmlSchema::Unwrap(info[0].ToObject())->compiled;
+  } else if (info[0].IsObject() &&
+             info[0].ToObject().InstanceOf(XmlDocument::constructor.Value())) {
+    XmlDocument *documentSchema =
+        Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+    compiled = XmlSchema::Compile(env, documentSchema->xml_obj, true);
+    if (!compiled) {
+      return env.Undefined();
+    }
+  } else {
     Napi::Error::New(env, "Must pass XmlDocument").ThrowAsJavaScriptException();
-    return scope.Escape(env.Undefined());
+    return env.Undefined();
   }
 
-  Napi::Array errors = Napi::Array::New(env);
-  ErrorArrayContext ctx{env, errors};
+  // validation writes to the document it checks (ID table, attribute types,
+  // dictionary), so the worker gets a copy the JS thread never sees
+  xmlDoc *copy = xmlCopyDoc(xml_obj, 1);
+  if (copy == NULL) {
+    Napi::Error::New(env, "Could not copy document")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  xmlResetLastError();
-  xmlSetStructuredErrorFunc(&ctx, XmlSyntaxError::PushToArray);
+  XmlValidateWorker *worker =
+      new XmlValidateWorker(env, this->Value(), copy, compiled);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
 
-  XmlDocument *documentSchema =
-      Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+  return promise;
+}
 
-  xmlRelaxNGParserCtxtPtr parser_ctxt =
-      xmlRelaxNGNewDocParserCtxt(documentSchema->xml_obj);
-  if (parser_ctxt == NULL) {
-    Napi::Error::New(env, "Could not create context for RELAX NG schema parser")
-        .ThrowAsJavaScriptException();
+Napi::Value XmlDocument::RngValidate(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::EscapableHandleScope scope(env);
+
+  if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
+    Napi::Error::New(env, "Must pass xsd").ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
 
-  xmlRelaxNGPtr schema = xmlRelaxNGParse(parser_ctxt);
-  if (schema == NULL) {
-    Napi::Error::New(env, "Invalid RELAX NG schema")
-        .ThrowAsJavaScriptException();
+  XmlRelaxNGCompiledPtr compiled;
+  if (info[0].IsObject() &&
+      info[0].ToObject().InstanceOf(XmlRelaxNGSchema::constructor.Value())) {
+    compiled = XmlRelaxNGSchema::Unwrap(info[0].ToObject())->compiled;
+  } else if (info[0].IsObject() &&
+             info[0].ToObject().InstanceOf(XmlDocument::constructor.Value())) {
+    XmlDocument *documentSchema =
+        Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+    compiled = XmlRelaxNGSchema::Compile(env, documentSchema->xml_obj);
+    if (!compiled) {
+      return scope.Escape(env.Undefined());
+    }
+  } else {
+    Napi::Error::New(env, "Must pass XmlDocument").ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
 
-  xmlRelaxNGValidCtxtPtr valid_ctxt = xmlRelaxNGNewValidCtxt(schema);
+  xmlRelaxNGValidCtxtPtr valid_ctxt = compiled->acquire();
   if (valid_ctxt == NULL) {
     Napi::Error::New(
         env, "Unable to create a validation context for the RELAX NG schema")
         .ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
+
+  Napi::Array errors = Napi::Array::New(env);
+  ErrorArrayContext ctx{env, errors};
+
+  xmlResetLastError();
+  xmlRelaxNGSetValidStructuredErrors(valid_ctxt, XmlSyntaxError::PushToArray,
+                                     &ctx);
+
   bool valid = xmlRelaxNGValidateDoc(valid_ctxt, xml_obj) == 0;
 
-  xmlSetStructuredErrorFunc(NULL, NULL);
+  compiled->release(valid_ctxt);
   this->Value().Set("validationErrors", errors);
 
-  xmlRelaxNGFreeValidCtxt(valid_ctxt);
-  xmlRelaxNGFree(schema);
-  xmlRelaxNGFreeParserCtxt(parser_ctxt);
-
   return scope.Escape(Napi::Boolean::New(env, valid));
 }
 
@@ -699,53 +1002,43 @@ Napi::Value XmlDocument::SchematronValidate(const Napi::CallbackInfo &info) {
     return scope.Escape(env.Undefined());
   }
 
-  if (!info[0].IsObject() ||
-      !info[0].ToObject().InstanceOf(constructor.Value())) {
+  XmlSchematronCompiledPtr compiled;
+  if (info[0].IsObject() &&
+      info[0].ToObject().InstanceOf(XmlSchematronSchema::constructor.Value())) {
+    compiled = XmlSchematronSchema::Unwrap(info[0].ToObject())->compiled;
+  } else if (info[0].IsObject() &&
+             info[0].ToObject().InstanceOf(XmlDocument::constructor.Value())) {
+    XmlDocument *documentSchema =
+        Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+    compiled =
+        XmlSchematronSchema::Compile(env, documentSchema->xml_obj, false);
+    if (!compiled) {
+      return scope.Escape(env.Undefined());
+    }
+  } else {
     Napi::Error::New(env, "Must pass XmlDocument").ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
 
-  ErrorArrayContext ctx{env, Napi::Array::New(env)};
-  xmlResetLastError();
-
-  XmlDocument *documentSchema =
-      Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
-
-  xmlSchematronParserCtxtPtr parser_ctxt =
-      xmlSchematronNewDocParserCtxt(documentSchema->xml_obj);
-  if (parser_ctxt == NULL) {
-    Napi::Error::New(env,
-                     "Could not create context for Schematron schema parser")
-        .ThrowAsJavaScriptException();
-    return scope.Escape(env.Undefined());
-  }
-
-  xmlSchematronPtr schema = xmlSchematronParse(parser_ctxt);
-  if (schema == NULL) {
-    Napi::Error::New(env, "Invalid Schematron schema")
-        .ThrowAsJavaScriptException();
-    return scope.Escape(env.Undefined());
-  }
-
   xmlSchematronValidCtxtPtr valid_ctxt =
-      xmlSchematronNewValidCtxt(schema, XML_SCHEMATRON_OUT_ERROR);
+      xmlSchematronNewValidCtxt(compiled->schema, XML_SCHEMATRON_OUT_ERROR);
   if (valid_ctxt == NULL) {
     Napi::Error::New(
         env, "Unable to create a validation context for the Schematron schema")
         .ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
+
+  ErrorArrayContext ctx{env, Napi::Array::New(env)};
+
+  xmlResetLastError();
   xmlSchematronSetValidStructuredErrors(valid_ctxt, XmlSyntaxError::PushToArray,
                                         reinterpret_cast<void *>(&ctx));
 
   bool valid = xmlSchematronValidateDoc(valid_ctxt, xml_obj) == 0;
 
-  xmlSchematronSetValidStructuredErrors(valid_ctxt, NULL, NULL);
-  this->Value().Set("validationErrors", ctx.errors);
-
   xmlSchematronFreeValidCtxt(valid_ctxt);
-  xmlSchematronFree(schema);
-  xmlSchematronFreeParserCtxt(parser_ctxt);
+  this->Value().Set("validationErrors", ctx.errors);
 
   return scope.Escape(Napi::Boolean::New(env, valid));
 }
@@ -759,12 +1052,16 @@ void XmlDocument::Init(Napi::Env env, Napi::Object exports) {
                       InstanceMethod("encoding", &XmlDocument::Encoding),
                       InstanceMethod("toString", &XmlDocument::ToString),
                       InstanceMethod("validate", &XmlDocument::Validate),
+                      InstanceMethod("validateAsync",
+                                     &XmlDocument::ValidateAsync),
                       InstanceMethod("rngValidate", &XmlDocument::RngValidate),
                       InstanceMethod("schematronValidate",
                                      &XmlDocument::SchematronValidate),
                       InstanceMethod("_setDtd", &XmlDocument::SetDtd),
                       InstanceMethod("getDtd", &XmlDocument::GetDtd),
                       InstanceMethod("type", &XmlDocument::Type),
+                      InstanceAccessor("errors", &XmlDocument::GetErrors,
+                                       &XmlDocument::SetErrors),
                   });
 
   constructor = Napi::Persistent(ctor);
@@ -774,7 +1071,17 @@ void XmlDocument::Init(Napi::Env env, Napi::Object exports) {
   exports.Set("Document", ctor);
   exports.Set("fromXml", Napi::Function::New(env, XmlDocument::FromXml));
   exports.Set("fromHtml", Napi::Function::New(env, XmlDocument::FromHtml));
+  exports.Set("parserPoolStats",
+              Napi::Function::New(env, XmlDocument::ParserPoolStats));
+  exports.Set("setParserPoolSize",
+              Napi::Function::New(env, XmlDocument::SetParserPoolSize));
+  exports.Set("fromXmlAsync",
+              Napi::Function::New(env, XmlDocument::FromXmlAsync));
+  exports.Set("fromHtmlAsync",
+              Napi::Function::New(env, XmlDocument::FromHtmlAsync));
 
   XmlNamespace::Init(env, exports);
+  XmlSchema::Init(env, exports);
+  XmlParserOptions::Init(env, exports);
 }
 } // namespace libxmljs
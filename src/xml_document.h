@@ -2,12 +2,67 @@
 #ifndef SRC_XML_DOCUMENT_H_
 #define SRC_XML_DOCUMENT_H_
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <libxml/parser.h>
 #include <libxml/tree.h>
 
 #include <napi.h>
 
+#include "xml_syntax_error.h"
+
 namespace libxmljs {
 
+// translate a JS options object into an xmlParserOption mask
+xmlParserOption getParserOptions(Napi::Object props);
+
+// the maxErrors option: how many parse errors are kept, unlimited if unset
+size_t getMaxErrors(Napi::Object props);
+
+// everything a parse takes from its JS options object
+struct XmlParseOptions {
+  XmlParseOptions()
+      : opts(0), max_errors(SIZE_MAX), exclude_implied_elements(false) {}
+
+  // decode props, or copy what a ParserOptions handle decoded already
+  static XmlParseOptions Read(Napi::Object props);
+
+  const char *base_url_or_null() const {
+    return base_url ? base_url->c_str() : NULL;
+  }
+  const char *encoding_or_null() const {
+    return encoding ? encoding->c_str() : NULL;
+  }
+
+  int opts;
+
+  // the base URL of the document
+  std::optional<std::string> base_url;
+
+  // unset to let libxml autodetect the encoding
+  std::optional<std::string> encoding;
+
+  size_t max_errors;
+
+  // HTML only: do not add implied html / body elements or a doctype
+  bool exclude_implied_elements;
+};
+
+// Parse options decoded once and reused for any number of parses,
+// created with libxml.createParserOptions()
+class XmlParserOptions : public Napi::ObjectWrap<XmlParserOptions> {
+public:
+  explicit XmlParserOptions(const Napi::CallbackInfo &info);
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  XmlParseOptions options;
+};
+
 class XmlDocument : public Napi::ObjectWrap<XmlDocument> {
 
 public:
@@ -27,9 +82,19 @@ public:
   // given xmlDoc object, intended for use in c++ space
   static Napi::Value NewInstance(Napi::Env env, xmlDoc *doc);
 
+  // errors seen while parsing the document, only turned into JS objects
+  // once `errors` is read
+  void set_parse_errors(std::vector<XmlErrorRecord> records);
+
 protected:
   static Napi::Value FromHtml(const Napi::CallbackInfo &info);
   static Napi::Value FromXml(const Napi::CallbackInfo &info);
+  static Napi::Value FromHtmlAsync(const Napi::CallbackInfo &info);
+  static Napi::Value FromXmlAsync(const Napi::CallbackInfo &info);
+
+  // statistics and size of the parser context pool of the JS thread
+  static Napi::Value ParserPoolStats(const Napi::CallbackInfo &info);
+  static Napi::Value SetParserPoolSize(const Napi::CallbackInfo &info);
 
   Napi::Value SetDtd(const Napi::CallbackInfo &info);
 
@@ -39,9 +104,11 @@ protected:
   Napi::Value Encoding(const Napi::CallbackInfo &info);
   Napi::Value Version(const Napi::CallbackInfo &info);
   Napi::Value Doc(const Napi::CallbackInfo &info);
-  Napi::Value Errors(const Napi::CallbackInfo &info);
+  Napi::Value GetErrors(const Napi::CallbackInfo &info);
+  void SetErrors(const Napi::CallbackInfo &info, const Napi::Value &value);
   Napi::Value ToString(const Napi::CallbackInfo &info);
   Napi::Value Validate(const Napi::CallbackInfo &info);
+  Napi::Value ValidateAsync(const Napi::CallbackInfo &info);
   Napi::Value RngValidate(const Napi::CallbackInfo &info);
   Napi::Value SchematronValidate(const Napi::CallbackInfo &info);
   Napi::Value Type(const Napi::CallbackInfo &info);
@@ -51,6 +118,11 @@ protected:
   static const int EXCLUDE_IMPLIED_ELEMENTS;
 
   void setEncoding(const std::string encoding);
+
+  // parse errors not converted yet, and the value of `errors` once they are
+  std::vector<XmlErrorRecord> parse_errors_;
+  bool errors_pending_;
+  Napi::Reference<Napi::Value> errors_;
 };
 
 } // namespace libxmljs
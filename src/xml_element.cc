@@ -19,16 +19,20 @@ namespace libxmljs {
 Napi::FunctionReference XmlElement::constructor;
 
 // JS-signature: (doc: Document, name: string, content?: string)
-XmlElement::XmlElement(const Napi::CallbackInfo &info) : XmlNode(info) {
+XmlElement::XmlElement(const Napi::CallbackInfo &info)
+    : XmlNode(info), child_index_generation(0) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
 
+  // created by NewWrapper() for an existing xml node
+  if (this->xml_obj != NULL) {
+    this->wrap_xml_obj();
+    return;
+  }
+
   xmlNode *elem;
 
-  if (info.Length() == 1 && info[0].IsExternal()) {
-    // Unwrap the external to get the xmlNode pointer
-    elem = info[0].As<Napi::External<xmlNode>>().Data();
-  } else if (info.Length() == 2 || info.Length() == 3) {
+  if (info.Length() == 2 || info.Length() == 3) {
     DOCUMENT_ARG_CHECK;
 
     XmlDocument *document =
@@ -63,15 +67,7 @@ XmlElement::XmlElement(const Napi::CallbackInfo &info) : XmlNode(info) {
   }
 
   this->xml_obj = elem;
-  this->xml_obj->_private = this;
-  this->ancestor = NULL;
-
-  if ((this->xml_obj->doc != NULL) && (this->xml_obj->doc->_private != NULL)) {
-    XmlDocument *doc = static_cast<XmlDocument *>(this->xml_obj->doc->_private);
-    this->Value().Set("document", doc->Value());
-  }
-
-  this->ref_wrapped_ancestor();
+  this->wrap_xml_obj();
 }
 
 Napi::Value XmlElement::NewInstance(Napi::Env env, xmlNode *node) {
@@ -84,10 +80,7 @@ Napi::Value XmlElement::NewInstance(Napi::Env env, xmlNode *node) {
     }
   }
 
-  Napi::Value external = Napi::External<xmlNode>::New(env, node);
-  Napi::Object instance = XmlElement::constructor.New({external});
-
-  return scope.Escape(instance);
+  return scope.Escape(XmlElement::NewWrapper(node));
 }
 
 Napi::Value XmlElement::Name(const Napi::CallbackInfo &info) {
@@ -168,10 +161,6 @@ Napi::Value XmlElement::AddChild(const Napi::CallbackInfo &info) {
 
   this->add_child(imported_child);
 
-  if (!will_merge && (imported_child->_private != NULL)) {
-    static_cast<XmlNode *>(imported_child->_private)->ref_wrapped_ancestor();
-  }
-
   return info.This();
 }
 
@@ -197,7 +186,22 @@ Napi::Value XmlElement::AddCData(const Napi::CallbackInfo &info) {
 Napi::Value XmlElement::Find(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
   Napi::EscapableHandleScope scope(env);
-  std::string xpath = info[0].As<Napi::String>().Utf8Value();
+
+  // either a precompiled libxml.XPath handle or an expression string,
+  // which is looked up in the compiled expression cache
+  XmlXPathCompiledPtr compiled;
+  if (info[0].IsObject() &&
+      info[0].As<Napi::Object>().InstanceOf(
+          XmlXPathExpression::constructor.Value())) {
+    compiled = XmlXPathExpression::Unwrap(info[0].As<Napi::Object>())->compiled;
+  } else {
+    std::string xpath = info[0].As<Napi::String>().Utf8Value();
+    compiled = XmlXPathCache::current().get(xpath);
+  }
+
+  if (!compiled) {
+    return scope.Escape(env.Null());
+  }
 
   XmlXpathContext ctxt(this->xml_obj);
 
@@ -219,7 +223,7 @@ Napi::Value XmlElement::Find(const Napi::CallbackInfo &info) {
     }
   }
 
-  Napi::Value res = ctxt.evaluate(env, (const xmlChar *)xpath.c_str());
+  Napi::Value res = ctxt.evaluate(env, compiled->comp);
   return scope.Escape(res);
 }
 
@@ -295,10 +299,6 @@ Napi::Value XmlElement::AddPrevSibling(const Napi::CallbackInfo &info) {
 
   this->add_prev_sibling(imported_sibling);
 
-  if (imported_sibling->_private != NULL) {
-    static_cast<XmlNode *>(imported_sibling->_private)->ref_wrapped_ancestor();
-  }
-
   return info[0];
 }
 
@@ -320,10 +320,6 @@ Napi::Value XmlElement::AddNextSibling(const Napi::CallbackInfo &info) {
 
   this->add_next_sibling(imported_sibling);
 
-  if (imported_sibling->_private != NULL) {
-    static_cast<XmlNode *>(imported_sibling->_private)->ref_wrapped_ancestor();
-  }
-
   return info[0];
 }
 
@@ -400,16 +396,30 @@ Napi::Value XmlElement::get_attrs(Napi::Env env) {
   return scope.Escape(attributes);
 }
 
-void XmlElement::add_cdata(xmlNode *cdata) { xmlAddChild(xml_obj, cdata); }
+void XmlElement::add_cdata(xmlNode *cdata) {
+  xmlAddChild(xml_obj, cdata);
+  XmlDetachedTrees::linked(cdata);
+}
+
+// children this close to the start are found faster by walking to them
+const size_t CHILD_INDEX_MIN_POSITION = 8;
 
 Napi::Value XmlElement::get_child(Napi::Env env, int32_t idx) {
   Napi::EscapableHandleScope scope(env);
-  xmlNode *child = this->xml_obj->children;
-
-  int32_t i = 0;
-  while (child && i < idx) {
-    child = child->next;
-    ++i;
+  xmlNode *child = NULL;
+
+  // a negative index has always given the first child
+  size_t pos = idx < 0 ? 0 : static_cast<size_t>(idx);
+  if (pos < CHILD_INDEX_MIN_POSITION) {
+    child = this->xml_obj->children;
+    for (size_t i = 0; child && i < pos; ++i) {
+      child = child->next;
+    }
+  } else {
+    const std::vector<xmlNode *> &index = this->get_child_index();
+    if (pos < index.size()) {
+      child = index[pos];
+    }
   }
 
   if (!child)
@@ -418,6 +428,23 @@ Napi::Value XmlElement::get_child(Napi::Env env, int32_t idx) {
   return scope.Escape(XmlNode::NewInstance(env, child));
 }
 
+/*
+ * Children by position, built on first use and again once the children
+ * changed since, so walking the children by index does not walk the list
+ * each time.
+ */
+const std::vector<xmlNode *> &XmlElement::get_child_index() {
+  size_t generation = get_child_generation(xml_obj);
+  if (child_index.empty() || (child_index_generation != generation)) {
+    child_index.clear();
+    for (xmlNode *child = xml_obj->children; child; child = child->next) {
+      child_index.push_back(child);
+    }
+    child_index_generation = generation;
+  }
+  return child_index;
+}
+
 Napi::Value XmlElement::get_child_nodes(Napi::Env env) {
   Napi::EscapableHandleScope scope(env);
   xmlNode *child = this->xml_obj->children;
@@ -454,10 +481,8 @@ void XmlElement::unlink_children() {
   xmlNode *cur = xml_obj->children;
   while (cur != NULL) {
     xmlNode *next = cur->next;
-    if (cur->_private != NULL) {
-      static_cast<XmlNode *>(cur->_private)->unref_wrapped_ancestor();
-    }
     xmlUnlinkNode(cur);
+    XmlDetachedTrees::unlinked(cur, xml_obj);
     cur = next;
   }
 }
@@ -516,16 +541,17 @@ Napi::Value XmlElement::get_prev_element(Napi::Env env) {
 }
 
 void XmlElement::replace_element(xmlNode *element) {
+  xmlNode *parent = xml_obj->parent;
   xmlReplaceNode(xml_obj, element);
-  if (element->_private != NULL) {
-    XmlNode *node = static_cast<XmlNode *>(element->_private);
-    node->ref_wrapped_ancestor();
-  }
+  XmlDetachedTrees::linked(element);
+  XmlDetachedTrees::unlinked(xml_obj, parent);
 }
 
 void XmlElement::replace_text(const char *content) {
   xmlNodePtr txt = xmlNewDocText(xml_obj->doc, (const xmlChar *)content);
+  xmlNode *parent = xml_obj->parent;
   xmlReplaceNode(xml_obj, txt);
+  XmlDetachedTrees::unlinked(xml_obj, parent);
 }
 
 bool XmlElement::child_will_merge(xmlNode *child) {
@@ -565,6 +591,7 @@ Napi::Function XmlElement::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod("toString", &XmlNode::ToString),
           InstanceMethod("remove", &XmlNode::Remove),
           InstanceMethod("clone", &XmlNode::Clone),
+          InstanceAccessor("document", &XmlNode::GetDocument, nullptr),
       });
 
   constructor = Napi::Persistent(func);
@@ -2,6 +2,8 @@
 #ifndef SRC_XML_ELEMENT_H_
 #define SRC_XML_ELEMENT_H_
 
+#include <vector>
+
 #include "libxmljs.h"
 #include "xml_node.h"
 
@@ -11,6 +13,8 @@ class XmlElement : public XmlNode<XmlElement> {
 public:
   XmlElement(const Napi::CallbackInfo &info);
 
+  static Napi::FunctionReference constructor;
+
   static Napi::Function Init(Napi::Env env, Napi::Object exports);
 
   // create new xml element to wrap the node
@@ -52,8 +56,12 @@ protected:
   void replace_text(const char *content);
   bool child_will_merge(xmlNode *child);
 
+  // children by position, see get_child_index()
+  const std::vector<xmlNode *> &get_child_index();
+
 private:
-  static Napi::FunctionReference constructor;
+  std::vector<xmlNode *> child_index;
+  size_t child_index_generation;
 };
 
 } // namespace libxmljs
@@ -11,9 +11,12 @@ namespace libxmljs {
 
 Napi::FunctionReference XmlNamespace::constructor;
 
+thread_local size_t XmlNamespace::instances = 0;
+
 XmlNamespace::XmlNamespace(const Napi::CallbackInfo &info)
     : Napi::ObjectWrap<XmlNamespace>(info) {
   Napi::Env env = info.Env();
+  instances++;
 
   // created for an already existing namespace
   if (info.Length() == 0) {
@@ -72,6 +75,8 @@ XmlNamespace::XmlNamespace(const Napi::CallbackInfo &info)
 }
 
 XmlNamespace::~XmlNamespace() {
+  instances--;
+
   /*
    * `xml_obj` may have been nulled by `xmlDeregisterNodeCallback` when
    * the `xmlNs` was freed along with an attached node or document.
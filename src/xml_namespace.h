@@ -20,6 +20,9 @@ public:
 
   static Napi::Value NewInstance(Napi::Env env, xmlNs *ns);
 
+  // wrappers alive on this thread
+  static thread_local size_t instances;
+
 protected:
   Napi::Value Href(const Napi::CallbackInfo &info);
   Napi::Value Prefix(const Napi::CallbackInfo &info);
@@ -1,5 +1,8 @@
 // Copyright 2009, Squish Tech, LLC.
 
+#include <unordered_map>
+#include <vector>
+
 #include <libxml/xmlsave.h>
 
 #include "xml_attribute.h"
@@ -15,9 +18,52 @@ namespace libxmljs {
 
 template <class T> Napi::FunctionReference XmlNode<T>::constructor;
 
+template <class T> thread_local xmlNode *XmlNode<T>::wrapping = NULL;
+
 template <class T>
 XmlNode<T>::XmlNode(const Napi::CallbackInfo &info)
-    : Napi::ObjectWrap<T>(info) {}
+    : Napi::ObjectWrap<T>(info), xml_obj(wrapping), document(NULL) {
+  wrapping = NULL;
+}
+
+template <class T> Napi::Object XmlNode<T>::NewWrapper(xmlNode *node) {
+  wrapping = node;
+  Napi::Object instance = T::constructor.New({});
+  wrapping = NULL;
+  return instance;
+}
+
+template <class T> void XmlNode<T>::wrap_xml_obj() {
+  this->xml_obj->_private = this;
+
+  xmlDoc *doc = this->xml_obj->doc;
+  if ((doc != NULL) && (doc->_private != NULL)) {
+    this->document = static_cast<XmlDocument *>(doc->_private);
+    this->document->Ref();
+  }
+
+  XmlDetachedTrees::wrapped(this->xml_obj);
+}
+
+template <class T> void XmlNode<T>::release_document() {
+  if (this->document == NULL) {
+    return;
+  }
+
+  // nothing to release while the document itself is being freed
+  if (this->document->xml_obj->_private != NULL) {
+    this->document->Unref();
+  }
+  this->document = NULL;
+}
+
+template <class T>
+Napi::Value XmlNode<T>::GetDocument(const Napi::CallbackInfo &info) {
+  if (this->document == NULL) {
+    return info.Env().Undefined();
+  }
+  return this->document->Value();
+}
 
 template <class T> Napi::Value XmlNode<T>::Doc(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
@@ -239,22 +285,6 @@ Napi::Value XmlNode<T>::NewInstance(Napi::Env env, xmlNode *node) {
   }
 }
 
-/*
- * Return the (non-document) root, or a wrapped ancestor: whichever is closest
- */
-xmlNode *get_wrapped_ancestor_or_root(xmlNode *xml_obj) {
-  while ((xml_obj->parent != NULL) &&
-         (static_cast<void *>(xml_obj->doc) !=
-          static_cast<void *>(xml_obj->parent)) &&
-         (xml_obj->parent->_private == NULL)) {
-    xml_obj = xml_obj->parent;
-  }
-  return ((xml_obj->parent != NULL) && (static_cast<void *>(xml_obj->doc) !=
-                                        static_cast<void *>(xml_obj->parent)))
-             ? xml_obj->parent
-             : xml_obj;
-}
-
 /*
  * Search linked list for javascript wrapper, ignoring given node.
  */
@@ -422,63 +452,279 @@ xmlNode *get_wrapped_descendant(xmlNode *xml_obj,
   return wrapped_descendant;
 }
 
-template <class T> XmlNode<T>::~XmlNode() {
-  if (this->xml_obj == NULL) {
+// count of changes to the children, for the elements whose children were
+// asked for by position
+static thread_local std::unordered_map<xmlNode *, size_t> child_generations;
+
+size_t get_child_generation(xmlNode *parent) {
+  return child_generations[parent];
+}
+
+static void children_changed(xmlNode *parent) {
+  if (child_generations.empty() || (parent == NULL)) {
     return;
   }
+  auto found = child_generations.find(parent);
+  if (found != child_generations.end()) {
+    found->second++;
+  }
+}
 
-  this->unref_wrapped_ancestor();
+// wrappers in a detached subtree, and the document it came from
+struct DetachedTree {
+  size_t wrappers;
+  xmlDoc *doc;
+};
 
-  this->xml_obj->_private = NULL;
-  if (this->xml_obj->parent == NULL) {
-    if (get_wrapped_descendant(this->xml_obj) == NULL) {
-      xmlFreeNode(this->xml_obj);
+// by root node
+static thread_local std::unordered_map<xmlNode *, DetachedTree> detached_trees;
+
+// number of detached trees by document
+static thread_local std::unordered_map<xmlDoc *, size_t> detached_documents;
+
+// detached trees left without wrappers by nodes libxml freed out of them.
+// libxml may still be working on such a tree, it is freed on the next
+// unwrap or link instead.
+static thread_local std::vector<xmlNode *> orphaned_trees;
+
+/*
+ * Root of the detached subtree xml_obj is in, or NULL if it is part of a
+ * document. Only walks up if the document has detached subtrees at all.
+ */
+static xmlNode *get_detached_root(xmlNode *xml_obj) {
+  if (xml_obj->parent == NULL) {
+    return xml_obj;
+  }
+  if (detached_documents.find(xml_obj->doc) == detached_documents.end()) {
+    return NULL;
+  }
+  while (xml_obj->parent != NULL) {
+    if ((xml_obj->parent->type == XML_DOCUMENT_NODE) ||
+        (xml_obj->parent->type == XML_HTML_DOCUMENT_NODE)) {
+      return NULL;
     }
-  } else {
-    xmlNode *ancestor = get_wrapped_ancestor_or_root(this->xml_obj);
-    if ((ancestor->_private == NULL) && (ancestor->parent == NULL) &&
-        (get_wrapped_descendant(ancestor, this->xml_obj) == NULL)) {
-      // xmlUnlinkNode(ancestor);
-      // xmlFreeNode(ancestor);
+    xml_obj = xml_obj->parent;
+  }
+  return xml_obj;
+}
+
+/*
+ * Count the node wrappers in the subtree of xml_obj, attributes included.
+ */
+static size_t count_wrapped_nodes(xmlNode *xml_obj) {
+  size_t count = 0;
+  xmlNode *cur = xml_obj;
+  while (cur != NULL) {
+    if (cur->_private != NULL) {
+      count++;
+    }
+
+    if (cur->type == XML_ELEMENT_NODE) {
+      for (xmlAttr *attr = cur->properties; attr != NULL; attr = attr->next) {
+        count += count_wrapped_nodes(reinterpret_cast<xmlNode *>(attr));
+      }
+    }
+
+    if ((cur->children != NULL) && (cur->type != XML_ENTITY_REF_NODE)) {
+      cur = cur->children;
+      continue;
+    }
+
+    while ((cur != xml_obj) && (cur->next == NULL)) {
+      cur = cur->parent;
+    }
+    cur = (cur == xml_obj) ? NULL : cur->next;
+  }
+  return count;
+}
+
+static void add_detached_tree(xmlNode *root, size_t wrappers) {
+  auto found = detached_trees.find(root);
+  if (found != detached_trees.end()) {
+    found->second.wrappers += wrappers;
+    return;
+  }
+  detached_trees[root] = {wrappers, root->doc};
+  detached_documents[root->doc]++;
+}
+
+typedef std::unordered_map<xmlNode *, DetachedTree>::iterator DetachedTreeIt;
+
+static void erase_detached_tree(DetachedTreeIt found) {
+  auto doc = detached_documents.find(found->second.doc);
+  if (--doc->second == 0) {
+    detached_documents.erase(doc);
+  }
+  detached_trees.erase(found);
+}
+
+/*
+ * Free a detached subtree no node wrapper refers to anymore. Namespace
+ * wrappers are not counted (an xmlNs does not know its node), so while there
+ * are any the subtree is searched for them.
+ */
+static void free_detached_tree(xmlNode *root) {
+  if ((XmlNamespace::instances == 0) ||
+      (get_wrapped_descendant(root) == NULL)) {
+    xmlFreeNode(root);
+  }
+}
+
+/*
+ * Take wrappers away from the detached subtree root, freeing it once none
+ * are left.
+ */
+static void release_detached_tree(xmlNode *root, size_t wrappers) {
+  auto found = detached_trees.find(root);
+  if (found == detached_trees.end()) {
+    return;
+  }
+  if (found->second.wrappers > wrappers) {
+    found->second.wrappers -= wrappers;
+    return;
+  }
+  erase_detached_tree(found);
+  free_detached_tree(root);
+}
+
+// free the orphaned trees that are still detached and without wrappers
+static void free_orphaned_trees() {
+  if (orphaned_trees.empty()) {
+    return;
+  }
+
+  std::vector<xmlNode *> roots;
+  roots.swap(orphaned_trees);
+  for (xmlNode *root : roots) {
+    // gone when it was freed or linked meanwhile; one that was just linked
+    // by the caller has a parent already
+    auto found = detached_trees.find(root);
+    if ((found != detached_trees.end()) && (found->second.wrappers == 0) &&
+        (root->parent == NULL)) {
+      erase_detached_tree(found);
+      free_detached_tree(root);
     }
   }
 }
 
-template <class T> xmlNode *XmlNode<T>::get_wrapped_ancestor() {
-  xmlNode *ancestor = get_wrapped_ancestor_or_root(this->xml_obj);
-  return ((this->xml_obj == ancestor) || (ancestor->_private == NULL))
-             ? NULL
-             : ancestor;
+void XmlDetachedTrees::wrapped(xmlNode *xml_obj) {
+  xmlNode *root = get_detached_root(xml_obj);
+  if (root != NULL) {
+    add_detached_tree(root, 1);
+  }
+}
+
+void XmlDetachedTrees::unwrapped(xmlNode *xml_obj) {
+  free_orphaned_trees();
+
+  xmlNode *root = get_detached_root(xml_obj);
+  if (root == NULL) {
+    return;
+  }
+  if (detached_trees.find(root) == detached_trees.end()) {
+    // not seen detached by the bindings, search it as a last resort
+    if ((root == xml_obj) && (get_wrapped_descendant(root) == NULL)) {
+      xmlFreeNode(root);
+    }
+    return;
+  }
+  release_detached_tree(root, 1);
+}
+
+void XmlDetachedTrees::unlinked(xmlNode *xml_obj, xmlNode *parent) {
+  children_changed(parent);
+  if (parent == NULL) {
+    return;
+  }
+
+  size_t wrappers = count_wrapped_nodes(xml_obj);
+  if (wrappers == 0) {
+    return;
+  }
+
+  xmlNode *root = get_detached_root(parent);
+  add_detached_tree(xml_obj, wrappers);
+  if (root != NULL) {
+    release_detached_tree(root, wrappers);
+  }
+}
+
+void XmlDetachedTrees::linked(xmlNode *xml_obj) {
+  children_changed(xml_obj->parent);
+  free_orphaned_trees();
+
+  auto found = detached_trees.find(xml_obj);
+  if (found == detached_trees.end()) {
+    return;
+  }
+
+  size_t wrappers = found->second.wrappers;
+  erase_detached_tree(found);
+
+  xmlNode *root = get_detached_root(xml_obj);
+  if (root != NULL) {
+    add_detached_tree(root, wrappers);
+  }
 }
 
-template <class T> void XmlNode<T>::ref_wrapped_ancestor() {
-  xmlNode *ancestor = this->get_wrapped_ancestor();
+void XmlDetachedTrees::freed(xmlNode *xml_obj) {
+  children_changed(xml_obj->parent);
+  if (!child_generations.empty()) {
+    child_generations.erase(xml_obj);
+  }
+  if (detached_trees.empty()) {
+    return;
+  }
 
-  // if our closest wrapped ancestor has changed then we either
-  // got removed, added, or a closer ancestor was wrapped
-  if (ancestor != this->ancestor) {
-    this->unref_wrapped_ancestor();
-    this->ancestor = ancestor;
+  if (xml_obj->parent == NULL) {
+    auto found = detached_trees.find(xml_obj);
+    if (found != detached_trees.end()) {
+      erase_detached_tree(found);
+    }
+    return;
   }
 
-  if (this->ancestor != NULL) {
-    XmlNode *node = static_cast<XmlNode *>(this->ancestor->_private);
-    node->Ref();
+  // a wrapped node freed out of a detached subtree that stays
+  if (xml_obj->_private != NULL) {
+    xmlNode *root = get_detached_root(xml_obj);
+    auto found = detached_trees.find(root);
+    if ((found != detached_trees.end()) && (--found->second.wrappers == 0)) {
+      orphaned_trees.push_back(root);
+    }
   }
 }
 
-template <class T> void XmlNode<T>::unref_wrapped_ancestor() {
-  if ((this->ancestor != NULL) && (this->ancestor->_private != NULL)) {
-    XmlNode *ancestor = static_cast<XmlNode *>(this->ancestor->_private);
-    try {
-      ancestor->Unref();
-    } catch (...) {
-      // Ignore errors during shutdown - the environment is being torn down
-      // anyway
+void XmlDetachedTrees::free_document(xmlDoc *doc) {
+  if (detached_documents.find(doc) == detached_documents.end()) {
+    return;
+  }
+
+  std::vector<xmlNode *> roots;
+  for (auto it = detached_trees.begin(); it != detached_trees.end();) {
+    if (it->second.doc == doc) {
+      roots.push_back(it->first);
+      it = detached_trees.erase(it);
+    } else {
+      ++it;
     }
   }
+  detached_documents.erase(doc);
 
-  this->ancestor = NULL;
+  // the wrappers still in these are unreachable as well, they just have not
+  // been finalized yet
+  for (xmlNode *root : roots) {
+    xmlFreeNode(root);
+  }
+}
+
+template <class T> XmlNode<T>::~XmlNode() {
+  this->release_document();
+  if (this->xml_obj == NULL) {
+    return;
+  }
+
+  this->xml_obj->_private = NULL;
+  XmlDetachedTrees::unwrapped(this->xml_obj);
 }
 
 template <class T> Napi::Value XmlNode<T>::get_doc(Napi::Env env) {
@@ -618,20 +864,30 @@ Napi::Value XmlNode<T>::to_string(Napi::Env env, int options) {
 }
 
 template <class T> void XmlNode<T>::remove() {
-  this->unref_wrapped_ancestor();
+  xmlNode *parent = this->xml_obj->parent;
   xmlUnlinkNode(this->xml_obj);
+  XmlDetachedTrees::unlinked(this->xml_obj, parent);
 }
 
+// the add functions return another node if they merged a text node into it,
+// the merged node is freed and so was never linked
+
 template <class T> void XmlNode<T>::add_child(xmlNode *child) {
-  xmlAddChild(xml_obj, child);
+  if (xmlAddChild(xml_obj, child) == child) {
+    XmlDetachedTrees::linked(child);
+  }
 }
 
 template <class T> void XmlNode<T>::add_prev_sibling(xmlNode *node) {
-  xmlAddPrevSibling(xml_obj, node);
+  if (xmlAddPrevSibling(xml_obj, node) == node) {
+    XmlDetachedTrees::linked(node);
+  }
 }
 
 template <class T> void XmlNode<T>::add_next_sibling(xmlNode *node) {
-  xmlAddNextSibling(xml_obj, node);
+  if (xmlAddNextSibling(xml_obj, node) == node) {
+    XmlDetachedTrees::linked(node);
+  }
 }
 
 template <class T> xmlNode *XmlNode<T>::import_node(xmlNode *node) {
@@ -645,54 +901,62 @@ template <class T> xmlNode *XmlNode<T>::import_node(xmlNode *node) {
   }
 }
 
-template <class T> Napi::Value XmlNode<T>::get_type(Napi::Env env) {
-  Napi::EscapableHandleScope scope(env);
-  switch (xml_obj->type) {
+const char *get_node_type_name(xmlElementType type) {
+  switch (type) {
   case XML_ELEMENT_NODE:
-    return scope.Escape(Napi::String::New(env, "element"));
+    return "element";
   case XML_ATTRIBUTE_NODE:
-    return scope.Escape(Napi::String::New(env, "attribute"));
+    return "attribute";
   case XML_TEXT_NODE:
-    return scope.Escape(Napi::String::New(env, "text"));
+    return "text";
   case XML_CDATA_SECTION_NODE:
-    return scope.Escape(Napi::String::New(env, "cdata"));
+    return "cdata";
   case XML_ENTITY_REF_NODE:
-    return scope.Escape(Napi::String::New(env, "entity_ref"));
+    return "entity_ref";
   case XML_ENTITY_NODE:
-    return scope.Escape(Napi::String::New(env, "entity"));
+    return "entity";
   case XML_PI_NODE:
-    return scope.Escape(Napi::String::New(env, "pi"));
+    return "pi";
   case XML_COMMENT_NODE:
-    return scope.Escape(Napi::String::New(env, "comment"));
+    return "comment";
   case XML_DOCUMENT_NODE:
-    return scope.Escape(Napi::String::New(env, "document"));
+    return "document";
   case XML_DOCUMENT_TYPE_NODE:
-    return scope.Escape(Napi::String::New(env, "document_type"));
+    return "document_type";
   case XML_DOCUMENT_FRAG_NODE:
-    return scope.Escape(Napi::String::New(env, "document_frag"));
+    return "document_frag";
   case XML_NOTATION_NODE:
-    return scope.Escape(Napi::String::New(env, "notation"));
+    return "notation";
   case XML_HTML_DOCUMENT_NODE:
-    return scope.Escape(Napi::String::New(env, "html_document"));
+    return "html_document";
   case XML_DTD_NODE:
-    return scope.Escape(Napi::String::New(env, "dtd"));
+    return "dtd";
   case XML_ELEMENT_DECL:
-    return scope.Escape(Napi::String::New(env, "element_decl"));
+    return "element_decl";
   case XML_ATTRIBUTE_DECL:
-    return scope.Escape(Napi::String::New(env, "attribute_decl"));
+    return "attribute_decl";
   case XML_ENTITY_DECL:
-    return scope.Escape(Napi::String::New(env, "entity_decl"));
+    return "entity_decl";
   case XML_NAMESPACE_DECL:
-    return scope.Escape(Napi::String::New(env, "namespace_decl"));
+    return "namespace_decl";
   case XML_XINCLUDE_START:
-    return scope.Escape(Napi::String::New(env, "xinclude_start"));
+    return "xinclude_start";
   case XML_XINCLUDE_END:
-    return scope.Escape(Napi::String::New(env, "xinclude_end"));
+    return "xinclude_end";
   case XML_DOCB_DOCUMENT_NODE:
-    return scope.Escape(Napi::String::New(env, "docb_document"));
+    return "docb_document";
   }
 
-  return env.Null();
+  return NULL;
+}
+
+template <class T> Napi::Value XmlNode<T>::get_type(Napi::Env env) {
+  Napi::EscapableHandleScope scope(env);
+  const char *name = get_node_type_name(xml_obj->type);
+  if (name == NULL) {
+    return env.Null();
+  }
+  return scope.Escape(Napi::String::New(env, name));
 }
 
 template <class T>
@@ -714,6 +978,8 @@ Napi::Function XmlNode<T>::Init(Napi::Env env, Napi::Object exports) {
           Napi::ObjectWrap<T>::InstanceMethod("toString", &XmlNode::ToString),
           Napi::ObjectWrap<T>::InstanceMethod("remove", &XmlNode::Remove),
           Napi::ObjectWrap<T>::InstanceMethod("clone", &XmlNode::Clone),
+          Napi::ObjectWrap<T>::InstanceAccessor(
+              "document", &XmlNode::GetDocument, nullptr),
       });
 
   constructor = Napi::Persistent(func);
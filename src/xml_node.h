@@ -2,11 +2,49 @@
 #ifndef SRC_XML_NODE_H_
 #define SRC_XML_NODE_H_
 
+#include <cstddef>
+
 #include <libxml/tree.h>
 #include <napi.h>
 
 namespace libxmljs {
 
+class XmlDocument;
+
+// Subtrees that are not part of a document, with the number of node
+// wrappers in each. Wrappers keep just their document alive, which owns
+// everything attached to it, so only detached subtrees need tracking: one
+// goes along with the last wrapper in it. Unlinks and links done by the
+// bindings must be reported so subtrees are tracked as they move. One per JS
+// thread.
+class XmlDetachedTrees {
+public:
+  // a wrapper was created for xml_obj
+  static void wrapped(xmlNode *xml_obj);
+
+  // the wrapper of xml_obj is gone, frees the detached subtree if it was the
+  // last one in it
+  static void unwrapped(xmlNode *xml_obj);
+
+  // xml_obj was unlinked from parent
+  static void unlinked(xmlNode *xml_obj, xmlNode *parent);
+
+  // xml_obj, possibly the root of a detached subtree, was linked
+  static void linked(xmlNode *xml_obj);
+
+  // libxml is about to free xml_obj
+  static void freed(xmlNode *xml_obj);
+
+  // doc is freed, and with it the detached subtrees that came from it
+  static void free_document(xmlDoc *doc);
+};
+
+// Count of changes to the children of parent: nodes linked or unlinked (as
+// reported to XmlDetachedTrees) and nodes freed out of it. Changes are only
+// counted from the first call for a parent on, anything derived from its
+// children is stale once the count moved on.
+size_t get_child_generation(xmlNode *parent);
+
 template <class T> class XmlNode : public Napi::ObjectWrap<T> {
 public:
   XmlNode(const Napi::CallbackInfo &info);
@@ -14,19 +52,21 @@ public:
 
   xmlNode *xml_obj;
 
-  // reference to a parent XmlNode or XmlElement
-  xmlNode *ancestor;
+  // wrapper of the document, held for as long as this wrapper is, NULL if
+  // the document was not wrapped or the node was freed
+  XmlDocument *document;
 
-  // referencing functions
-  void ref_wrapped_ancestor();
-  void unref_wrapped_ancestor();
-  xmlNode *get_wrapped_ancestor();
+  // stop holding the document, once the node is freed
+  void release_document();
 
   static Napi::FunctionReference constructor;
 
   // create new XmlElement, XmlAttribute, etc. to wrap a libxml xmlNode
   static Napi::Value NewInstance(Napi::Env env, xmlNode *node);
 
+  // new T for node, without passing the node through the JS constructor
+  static Napi::Object NewWrapper(xmlNode *node);
+
   static Napi::Function Init(Napi::Env env, Napi::Object exports);
 
   Napi::Value Doc(const Napi::CallbackInfo &info);
@@ -40,8 +80,16 @@ public:
   Napi::Value ToString(const Napi::CallbackInfo &info);
   Napi::Value Remove(const Napi::CallbackInfo &info);
   Napi::Value Clone(const Napi::CallbackInfo &info);
+  Napi::Value GetDocument(const Napi::CallbackInfo &info);
 
 protected:
+  // node handed to the next T constructed by NewWrapper(), taken over by the
+  // XmlNode constructor
+  static thread_local xmlNode *wrapping;
+
+  // point xml_obj back at this wrapper and hold on to its document
+  void wrap_xml_obj();
+
   Napi::Value get_doc(Napi::Env env);
   Napi::Value remove_namespace(Napi::Env env);
   Napi::Value get_namespace(Napi::Env env);
@@ -73,6 +121,9 @@ public:
 
 Napi::Value SetupXmlNodeInheritance(Napi::Env env, Napi::Object exports);
 
+// name of a node type as returned by type(), NULL if there is none
+const char *get_node_type_name(xmlElementType type);
+
 } // namespace libxmljs
 
 #endif // SRC_XML_NODE_H_
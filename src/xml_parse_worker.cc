@@ -0,0 +1,123 @@
+// Copyright 2009, Squish Tech, LLC.
+
+#include <libxml/HTMLparser.h>
+#include <libxml/parser.h>
+#include <libxml/xinclude.h>
+
+#include "xml_document.h"
+#include "xml_parse_worker.h"
+#include "xml_parser_pool.h"
+
+namespace libxmljs {
+
+XmlParseWorker::XmlParseWorker(Napi::Env env, DocumentType type,
+                               Napi::Value input, Napi::Object options)
+    : Napi::AsyncWorker(env), deferred(Napi::Promise::Deferred::New(env)),
+      type(type), data(NULL), length(0), opts(0), doc(NULL) {
+  if (input.IsBuffer()) {
+    Napi::Buffer<char> buf = input.As<Napi::Buffer<char>>();
+    buffer_ref = Napi::Persistent(buf);
+    data = buf.Data();
+    length = buf.Length();
+  } else {
+    str = input.ToString().Utf8Value();
+    data = str.c_str();
+    length = str.length();
+  }
+
+  XmlParseOptions parse_options = XmlParseOptions::Read(options);
+  baseUrl = parse_options.base_url;
+  encoding = parse_options.encoding;
+  opts = parse_options.opts;
+  errors.max_errors = parse_options.max_errors;
+  if (type == HTML && parse_options.exclude_implied_elements) {
+    opts |= HTML_PARSE_NOIMPLIED | HTML_PARSE_NODEFDTD;
+  }
+}
+
+XmlParseWorker::~XmlParseWorker() {
+  // only set if the document was never handed over to a wrapper
+  if (doc != NULL) {
+    xmlFreeDoc(doc);
+  }
+}
+
+// runs on the threadpool: must not touch any napi value
+void XmlParseWorker::Execute() {
+  const char *url = baseUrl ? baseUrl->c_str() : NULL;
+  const char *enc = encoding ? encoding->c_str() : NULL;
+
+  // the structured error handler and last error are thread local
+  xmlResetLastError();
+  xmlSetStructuredErrorFunc(&errors, XmlSyntaxError::PushToCollector);
+
+  // pooled per threadpool thread, the document goes to the JS thread so it
+  // must not share a dictionary with the next parse here
+  XmlParserPool &pool = XmlParserPool::current();
+  pool.keep_dictionary = false;
+  doc = pool.read_memory(type == HTML, data, length, url, enc, opts,
+                         fatal_error);
+
+  xmlSetStructuredErrorFunc(NULL, NULL);
+
+  if (!doc) {
+    if (fatal_error) {
+      return;
+    }
+    SetError("Could not parse XML string");
+    return;
+  }
+
+  if (type == HTML) {
+    return;
+  }
+
+  if (opts & XML_PARSE_XINCLUDE) {
+    xmlSetStructuredErrorFunc(&errors, XmlSyntaxError::PushToCollector);
+    int ret = xmlXIncludeProcessFlags(doc, opts);
+    xmlSetStructuredErrorFunc(NULL, NULL);
+
+    if (ret < 0) {
+      xmlFreeDoc(doc);
+      doc = NULL;
+
+      const xmlError *error = xmlGetLastError();
+      if (error) {
+        fatal_error.emplace(error);
+        return;
+      }
+      SetError("Could not perform XInclude substitution");
+      return;
+    }
+  }
+
+  if (xmlDocGetRootElement(doc) == NULL) {
+    xmlFreeDoc(doc);
+    doc = NULL;
+    SetError("parsed document has no root element");
+  }
+}
+
+void XmlParseWorker::OnOK() {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  if (fatal_error) {
+    deferred.Reject(
+        XmlSyntaxError::BuildSyntaxError(env, *fatal_error).Value());
+    return;
+  }
+
+  Napi::Object doc_handle = XmlDocument::NewInstance(env, doc).ToObject();
+  doc = NULL;
+  XmlDocument::Unwrap(doc_handle)->set_parse_errors(std::move(errors.records));
+
+  deferred.Resolve(doc_handle);
+}
+
+void XmlParseWorker::OnError(const Napi::Error &error) {
+  Napi::HandleScope scope(Env());
+  deferred.Reject(error.Value());
+}
+
+} // namespace libxmljs
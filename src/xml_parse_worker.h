@@ -0,0 +1,55 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_PARSE_WORKER_H_
+#define SRC_XML_PARSE_WORKER_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <libxml/tree.h>
+
+#include "libxmljs.h"
+#include "xml_syntax_error.h"
+
+namespace libxmljs {
+
+// Parses an XML or HTML document on the libuv threadpool and resolves a
+// promise with the wrapped document once done. The JS thread is only used to
+// read the arguments and to wrap the finished xmlDoc.
+class XmlParseWorker : public Napi::AsyncWorker {
+public:
+  enum DocumentType { XML, HTML };
+
+  XmlParseWorker(Napi::Env env, DocumentType type, Napi::Value input,
+                 Napi::Object options);
+  virtual ~XmlParseWorker();
+
+  Napi::Promise Promise() { return deferred.Promise(); }
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &error) override;
+
+private:
+  Napi::Promise::Deferred deferred;
+  DocumentType type;
+
+  // string input is copied, buffer input is referenced until we are done
+  std::string str;
+  Napi::Reference<Napi::Buffer<char>> buffer_ref;
+  const char *data;
+  size_t length;
+
+  std::optional<std::string> baseUrl;
+  std::optional<std::string> encoding;
+  int opts;
+
+  xmlDoc *doc;
+  XmlErrorCollector errors;
+  std::optional<XmlErrorRecord> fatal_error;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_PARSE_WORKER_H_
@@ -0,0 +1,153 @@
+// Copyright 2009, Squish Tech, LLC.
+#include <libxml/HTMLparser.h>
+#include <libxml/SAX2.h>
+#include <libxml/parserInternals.h>
+
+#include "xml_parser_pool.h"
+
+namespace libxmljs {
+
+// default number of idle contexts kept
+const size_t PARSER_POOL_DEFAULT_CAPACITY = 4;
+
+// bytes of names a pooled dictionary may hold before it is replaced
+const size_t PARSER_POOL_DICTIONARY_USAGE = 64 * 1024;
+
+XmlParserPool::XmlParserPool()
+    : capacity(PARSER_POOL_DEFAULT_CAPACITY), keep_dictionary(true), hits(0),
+      misses(0) {}
+
+XmlParserPool::~XmlParserPool() { set_capacity(0); }
+
+XmlParserPool &XmlParserPool::current() {
+  static thread_local XmlParserPool pool;
+  return pool;
+}
+
+xmlDoc *XmlParserPool::read_memory(bool html, const char *data, size_t length,
+                                   const char *url, const char *encoding,
+                                   int opts,
+                                   std::optional<XmlErrorRecord> &fatal_error) {
+  xmlParserCtxt *ctxt = acquire(html);
+
+  xmlDoc *doc;
+  if (ctxt == NULL) {
+    doc = html ? htmlReadMemory(data, length, url, encoding, opts)
+               : xmlReadMemory(data, length, url, encoding, opts);
+  } else if (html) {
+    doc = htmlCtxtReadMemory(ctxt, data, length, url, encoding, opts);
+  } else {
+    doc = xmlCtxtReadMemory(ctxt, data, length, url, encoding, opts);
+  }
+
+  if (doc == NULL) {
+    const xmlError *error = ctxt ? xmlCtxtGetLastError(ctxt) : NULL;
+    if (error == NULL || error->code == XML_ERR_OK) {
+      error = xmlGetLastError();
+    }
+    if (error != NULL) {
+      fatal_error.emplace(error);
+    }
+  }
+
+  if (ctxt != NULL) {
+    release(ctxt, html);
+  }
+
+  return doc;
+}
+
+xmlParserCtxt *XmlParserPool::acquire(bool html) {
+  std::vector<xmlParserCtxt *> &idle = html ? html_ : xml_;
+  if (!idle.empty()) {
+    hits++;
+    xmlParserCtxt *ctxt = idle.back();
+    idle.pop_back();
+    return ctxt;
+  }
+
+  misses++;
+  return html ? htmlNewParserCtxt() : xmlNewParserCtxt();
+}
+
+static void free_context(xmlParserCtxt *ctxt, bool html) {
+  if (html) {
+    htmlFreeParserCtxt(ctxt);
+  } else {
+    xmlFreeParserCtxt(ctxt);
+  }
+}
+
+void XmlParserPool::release(xmlParserCtxt *ctxt, bool html) {
+  if (size() >= capacity) {
+    free_context(ctxt, html);
+    return;
+  }
+
+  // The parsed document holds on to the dictionary its names were interned
+  // in. Documents that stay on this thread share it with the next parse,
+  // which then finds the names it has seen before already interned.
+  // Dictionaries do no locking, so documents handed to another thread get
+  // one of their own, and so does the next parse once the dictionary has
+  // outgrown PARSER_POOL_DICTIONARY_USAGE (it would otherwise grow for as
+  // long as the context is pooled and eventually hit the dictionary limit).
+  xmlDict *dict = NULL;
+  if (!keep_dictionary || ctxt->dict == NULL ||
+      xmlDictGetUsage(ctxt->dict) > PARSER_POOL_DICTIONARY_USAGE) {
+    dict = xmlDictCreate();
+    if (dict == NULL) {
+      free_context(ctxt, html);
+      return;
+    }
+    xmlDictSetLimit(dict, XML_MAX_DICTIONARY_LIMIT);
+  }
+
+  // reset while the old dictionary is still there, the state freed by the
+  // reset may point into it
+  if (html) {
+    htmlCtxtReset(ctxt);
+  } else {
+    xmlCtxtReset(ctxt);
+  }
+
+  if (dict != NULL) {
+    xmlDictFree(ctxt->dict);
+    ctxt->dict = dict;
+    ctxt->str_xml = xmlDictLookup(dict, BAD_CAST "xml", 3);
+    ctxt->str_xmlns = xmlDictLookup(dict, BAD_CAST "xmlns", 5);
+    ctxt->str_xml_ns = xmlDictLookup(dict, XML_XML_NAMESPACE, 36);
+  }
+
+  // options like noblanks and nocdata work by replacing callbacks of the
+  // context's own SAX handler, neither the reset nor clearing the options
+  // puts them back
+  if (html) {
+    xmlSAX2InitHtmlDefaultSAXHandler(ctxt->sax);
+  } else {
+    xmlSAXVersion(ctxt->sax, 2);
+  }
+
+  // some options are only ever added to by the read functions, start the
+  // next parse from none so it gets exactly the ones it asks for
+  if (html) {
+    htmlCtxtSetOptions(ctxt, 0);
+  } else {
+    xmlCtxtSetOptions(ctxt, 0);
+  }
+
+  (html ? html_ : xml_).push_back(ctxt);
+}
+
+void XmlParserPool::set_capacity(size_t new_capacity) {
+  capacity = new_capacity;
+  while (size() > capacity && !xml_.empty()) {
+    xmlFreeParserCtxt(xml_.back());
+    xml_.pop_back();
+  }
+  while (size() > capacity) {
+    htmlFreeParserCtxt(html_.back());
+    html_.pop_back();
+  }
+}
+
+} // namespace libxmljs
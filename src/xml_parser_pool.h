@@ -0,0 +1,57 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_PARSER_POOL_H_
+#define SRC_XML_PARSER_POOL_H_
+
+#include <optional>
+#include <vector>
+
+#include <libxml/parser.h>
+
+#include "xml_syntax_error.h"
+
+namespace libxmljs {
+
+// Parser contexts kept around between parses of in-memory documents, so
+// that parsing a small message does not pay for setting up and tearing down
+// a context (input stacks, node and name tables, the dictionary) every time.
+// One per thread, like the structured error handler the parses report to.
+class XmlParserPool {
+public:
+  static XmlParserPool &current();
+
+  ~XmlParserPool();
+
+  // parse data as an XML or HTML document with a pooled context. If no
+  // document comes out, fatal_error holds the error that stopped the parse
+  // (if there was one).
+  xmlDoc *read_memory(bool html, const char *data, size_t length,
+                      const char *url, const char *encoding, int opts,
+                      std::optional<XmlErrorRecord> &fatal_error);
+
+  void set_capacity(size_t capacity);
+
+  size_t capacity;
+  // whether parses may share a dictionary, only when the documents stay on
+  // this thread
+  bool keep_dictionary;
+  size_t hits;
+  size_t misses;
+  size_t size() const { return xml_.size() + html_.size(); }
+
+private:
+  XmlParserPool();
+
+  // idle context of the given kind, or a new one (NULL if out of memory)
+  xmlParserCtxt *acquire(bool html);
+
+  // return ctxt to the pool, or free it if the pool is full
+  void release(xmlParserCtxt *ctxt, bool html);
+
+  // idle contexts, capacity applies to both kinds together
+  std::vector<xmlParserCtxt *> xml_;
+  std::vector<xmlParserCtxt *> html_;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_PARSER_POOL_H_
@@ -18,57 +18,45 @@ XmlProcessingInstruction::XmlProcessingInstruction(
 
   // if we were created for an existing xml node, then we don't need
   // to create a new node on the document
-  xmlNode *pi;
-
-  if (info.Length() == 1 && info[0].IsExternal()) {
-    // Unwrap the external to get the xmlNode pointer
-    pi = info[0].As<Napi::External<xmlNode>>().Data();
-  } else {
-    DOCUMENT_ARG_CHECK;
+  if (this->xml_obj != NULL) {
+    this->wrap_xml_obj();
+    return;
+  }
 
-    if (!info[1].IsString()) {
-      Napi::TypeError::New(env, "name argument must be of type string")
-          .ThrowAsJavaScriptException();
-      return;
-    }
+  DOCUMENT_ARG_CHECK;
 
-    Napi::Object docObj = info[0].As<Napi::Object>();
-    XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(docObj);
-    if (document == nullptr) {
-      Napi::Error::New(env, "Invalid document argument")
-          .ThrowAsJavaScriptException();
-      return;
-    }
-
-    std::string name = info[1].As<Napi::String>().Utf8Value();
-
-    const char *content = nullptr;
-    std::string contentStr;
-    if (info.Length() > 2) {
-      if (info[2].IsString()) {
-        contentStr = info[2].As<Napi::String>().Utf8Value();
-        content = contentStr.c_str();
-      } else if (!info[2].IsNull() && !info[2].IsUndefined()) {
-        Napi::TypeError::New(env, "content argument must be of type string")
-            .ThrowAsJavaScriptException();
-        return;
-      }
-    }
+  if (!info[1].IsString()) {
+    Napi::TypeError::New(env, "name argument must be of type string")
+        .ThrowAsJavaScriptException();
+    return;
+  }
 
-    pi = xmlNewDocPI(document->xml_obj, (const xmlChar *)name.c_str(),
-                     (xmlChar *)content);
+  Napi::Object docObj = info[0].As<Napi::Object>();
+  XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(docObj);
+  if (document == nullptr) {
+    Napi::Error::New(env, "Invalid document argument")
+        .ThrowAsJavaScriptException();
+    return;
   }
 
-  this->xml_obj = pi;
-  this->xml_obj->_private = this;
-  this->ancestor = NULL;
+  std::string name = info[1].As<Napi::String>().Utf8Value();
 
-  if ((xml_obj->doc != NULL) && (xml_obj->doc->_private != NULL)) {
-    XmlDocument *doc = static_cast<XmlDocument *>(this->xml_obj->doc->_private);
-    this->Value().Set("document", doc->Value());
+  const char *content = nullptr;
+  std::string contentStr;
+  if (info.Length() > 2) {
+    if (info[2].IsString()) {
+      contentStr = info[2].As<Napi::String>().Utf8Value();
+      content = contentStr.c_str();
+    } else if (!info[2].IsNull() && !info[2].IsUndefined()) {
+      Napi::TypeError::New(env, "content argument must be of type string")
+          .ThrowAsJavaScriptException();
+      return;
+    }
   }
 
-  this->ref_wrapped_ancestor();
+  this->xml_obj = xmlNewDocPI(document->xml_obj, (const xmlChar *)name.c_str(),
+                              (xmlChar *)content);
+  this->wrap_xml_obj();
 }
 
 Napi::Value XmlProcessingInstruction::NewInstance(Napi::Env env,
@@ -82,8 +70,7 @@ Napi::Value XmlProcessingInstruction::NewInstance(Napi::Env env,
     }
   }
 
-  auto external = Napi::External<xmlNode>::New(env, node);
-  Napi::Object instance = constructor.New({external});
+  Napi::Object instance = XmlProcessingInstruction::NewWrapper(node);
   return scope.Escape(instance);
 }
 
@@ -160,6 +147,8 @@ Napi::Function XmlProcessingInstruction::Init(Napi::Env env,
                       InstanceMethod("toString", &XmlNode::ToString),
                       InstanceMethod("remove", &XmlNode::Remove),
                       InstanceMethod("clone", &XmlNode::Clone),
+                      InstanceAccessor("document", &XmlNode::GetDocument,
+                                       nullptr),
                   });
 
   constructor = Napi::Persistent(func);
@@ -0,0 +1,254 @@
+// Copyright 2009, Squish Tech, LLC.
+
+#include <libxml/SAX2.h>
+
+#include "xml_document.h"
+#include "xml_element.h"
+#include "xml_record_splitter.h"
+
+namespace libxmljs {
+
+static XmlRecordSplitter *splitter_from_context(void *context) {
+  xmlParserCtxt *ctxt = static_cast<xmlParserCtxt *>(context);
+  return static_cast<XmlRecordSplitter *>(ctxt->_private);
+}
+
+Napi::FunctionReference XmlRecordSplitter::constructor;
+
+// JS-signature: (filter: { names?, uris?, patterns?, namespaces? },
+//                options?: object)
+XmlRecordSplitter::XmlRecordSplitter(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlRecordSplitter>(info), context_(NULL) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() == 0 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "RecordSplitter requires a filter")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  XmlSaxFilterPtr filter = XmlSaxFilter::Compile(env, info[0].ToObject());
+  if (!filter) {
+    return;
+  }
+  filter_.reset(new XmlSaxFilterState(filter));
+
+  Napi::Object options =
+      info.Length() > 1 && info[1].IsObject() ? info[1].ToObject()
+                                              : Napi::Object::New(env);
+  int opts = XmlParseOptions::Read(options).opts;
+
+  // SAX1 reports elements to startElement instead of the callbacks below,
+  // the whole document would be built and no record split off
+  if (opts & XML_PARSE_SAX1) {
+    Napi::TypeError::New(env,
+                         "Bad Argument: RecordSplitter does not support sax1")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  // the default tree builder, cut down to the selected subtrees
+  xmlSAXHandler handler;
+  xmlSAXVersion(&handler, 2);
+  handler.startElementNs = XmlRecordSplitter::start_element_ns;
+  handler.endElementNs = XmlRecordSplitter::end_element_ns;
+  handler.characters = XmlRecordSplitter::characters;
+  handler.ignorableWhitespace = XmlRecordSplitter::characters;
+  handler.cdataBlock = XmlRecordSplitter::cdata_block;
+  handler.comment = XmlRecordSplitter::comment;
+  handler.processingInstruction = XmlRecordSplitter::processing_instruction;
+  handler.reference = XmlRecordSplitter::reference;
+
+  context_ = xmlCreatePushParserCtxt(&handler, NULL, NULL, 0, NULL);
+  if (context_ == NULL) {
+    Napi::Error::New(env, "Could not create record splitter")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  context_->_private = this;
+  xmlCtxtUseOptions(context_, opts);
+  xmlCtxtSetErrorHandler(context_, XmlSyntaxError::PushToRecords, &errors_);
+}
+
+XmlRecordSplitter::~XmlRecordSplitter() { close(); }
+
+void XmlRecordSplitter::close() {
+  for (xmlDoc *record : records_) {
+    xmlFreeDoc(record);
+  }
+  records_.clear();
+
+  if (context_ != NULL) {
+    if (context_->myDoc != NULL) {
+      xmlFreeDoc(context_->myDoc);
+      context_->myDoc = NULL;
+    }
+    xmlFreeParserCtxt(context_);
+    context_ = NULL;
+  }
+}
+
+// JS-signature: (chunk: string | Uint8Array, terminate?: boolean) =>
+//               Element[]
+Napi::Value XmlRecordSplitter::Push(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::EscapableHandleScope scope(env);
+
+  if (context_ == NULL) {
+    Napi::Error::New(env, "RecordSplitter is closed")
+        .ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+
+  bool terminate = info.Length() > 1 ? info[1].ToBoolean().Value() : false;
+  size_t error_count = errors_.size();
+
+  if (info.Length() > 0 && info[0].IsTypedArray() &&
+      info[0].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+    // bytes are parsed in place, libxml detects their encoding
+    Napi::Uint8Array bytes = info[0].As<Napi::Uint8Array>();
+    xmlParseChunk(context_, reinterpret_cast<const char *>(bytes.Data()),
+                  bytes.ByteLength(), terminate);
+  } else if (info.Length() > 0 && info[0].IsString()) {
+    Utf8Scratch chunk(info[0].As<Napi::String>());
+    xmlParseChunk(context_, chunk.data(), chunk.length(), terminate);
+  } else {
+    Napi::TypeError::New(env, "RecordSplitter requires a string or Buffer")
+        .ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+
+  if (!context_->recovery) {
+    for (size_t i = error_count; i < errors_.size(); ++i) {
+      if (errors_[i].level == XML_ERR_FATAL) {
+        XmlErrorRecord fatal = errors_[i];
+        close();
+        XmlSyntaxError::BuildSyntaxError(env, fatal)
+            .ThrowAsJavaScriptException();
+        return scope.Escape(env.Undefined());
+      }
+    }
+  }
+
+  Napi::Array records = Napi::Array::New(env, records_.size());
+  for (size_t i = 0; i < records_.size(); ++i) {
+    // wrapping the document first lets it own the record
+    XmlDocument::NewInstance(env, records_[i]);
+    records.Set(i, XmlElement::NewInstance(
+                       env, xmlDocGetRootElement(records_[i])));
+  }
+  records_.clear();
+
+  if (terminate) {
+    close();
+  }
+
+  return scope.Escape(records);
+}
+
+// recoverable errors and warnings seen so far
+Napi::Value XmlRecordSplitter::Errors(const Napi::CallbackInfo &info) {
+  return XmlSyntaxError::BuildSyntaxErrors(info.Env(), errors_);
+}
+
+Napi::Value XmlRecordSplitter::Close(const Napi::CallbackInfo &info) {
+  close();
+  return info.Env().Undefined();
+}
+
+void XmlRecordSplitter::start_element_ns(
+    void *context, const xmlChar *localname, const xmlChar *prefix,
+    const xmlChar *uri, int nb_namespaces, const xmlChar **namespaces,
+    int nb_attributes, int nb_defaulted, const xmlChar **attributes) {
+  XmlRecordSplitter *splitter = splitter_from_context(context);
+
+  // elements outside of records are built as well, the records need a
+  // parent while they are under construction
+  splitter->filter_->enter(localname, uri);
+  xmlSAX2StartElementNs(context, localname, prefix, uri, nb_namespaces,
+                        namespaces, nb_attributes, nb_defaulted, attributes);
+}
+
+void XmlRecordSplitter::end_element_ns(void *context,
+                                       const xmlChar *localname,
+                                       const xmlChar *prefix,
+                                       const xmlChar *uri) {
+  xmlParserCtxt *ctxt = static_cast<xmlParserCtxt *>(context);
+  XmlRecordSplitter *splitter = splitter_from_context(context);
+  xmlNode *node = ctxt->node;
+
+  bool record = splitter->filter_->at_selected_root();
+  bool selected = splitter->filter_->leave();
+  xmlSAX2EndElementNs(context, localname, prefix, uri);
+
+  if (node == NULL || (selected && !record)) {
+    return;
+  }
+
+  if (record) {
+    xmlDoc *doc = xmlNewDoc((const xmlChar *)"1.0");
+    xmlNode *copy = xmlDocCopyNode(node, doc, 1);
+    if (copy != NULL) {
+      xmlDocSetRootElement(doc, copy);
+      splitter->records_.push_back(doc);
+    } else {
+      xmlFreeDoc(doc);
+    }
+  }
+
+  // the parser is done with the element, nothing refers to it any more
+  xmlUnlinkNode(node);
+  xmlFreeNode(node);
+}
+
+void XmlRecordSplitter::characters(void *context, const xmlChar *ch,
+                                   int len) {
+  if (splitter_from_context(context)->filter_->selected()) {
+    xmlSAX2Characters(context, ch, len);
+  }
+}
+
+void XmlRecordSplitter::cdata_block(void *context, const xmlChar *value,
+                                    int len) {
+  if (splitter_from_context(context)->filter_->selected()) {
+    xmlSAX2CDataBlock(context, value, len);
+  }
+}
+
+void XmlRecordSplitter::comment(void *context, const xmlChar *value) {
+  if (splitter_from_context(context)->filter_->selected()) {
+    xmlSAX2Comment(context, value);
+  }
+}
+
+void XmlRecordSplitter::processing_instruction(void *context,
+                                               const xmlChar *target,
+                                               const xmlChar *data) {
+  if (splitter_from_context(context)->filter_->selected()) {
+    xmlSAX2ProcessingInstruction(context, target, data);
+  }
+}
+
+void XmlRecordSplitter::reference(void *context, const xmlChar *name) {
+  if (splitter_from_context(context)->filter_->selected()) {
+    xmlSAX2Reference(context, name);
+  }
+}
+
+void XmlRecordSplitter::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func =
+      DefineClass(env, "RecordSplitter",
+                  {
+                      InstanceMethod("push", &XmlRecordSplitter::Push),
+                      InstanceMethod("errors", &XmlRecordSplitter::Errors),
+                      InstanceMethod("close", &XmlRecordSplitter::Close),
+                  });
+
+  constructor = Napi::Persistent(func);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("RecordSplitter", func);
+}
+
+} // namespace libxmljs
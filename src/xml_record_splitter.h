@@ -0,0 +1,62 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_RECORD_SPLITTER_H_
+#define SRC_XML_RECORD_SPLITTER_H_
+
+#include <vector>
+
+#include <libxml/parser.h>
+
+#include "libxmljs.h"
+#include "xml_sax_parser.h"
+#include "xml_syntax_error.h"
+
+namespace libxmljs {
+
+// Push parser building only the element subtrees selected by a filter.
+// Every selected subtree is moved into a document of its own once its end
+// tag was seen; everything outside of them is freed again as soon as it is
+// complete, so memory use depends on the record size, not on the input.
+class XmlRecordSplitter : public Napi::ObjectWrap<XmlRecordSplitter> {
+public:
+  explicit XmlRecordSplitter(const Napi::CallbackInfo &info);
+  ~XmlRecordSplitter();
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+private:
+  Napi::Value Push(const Napi::CallbackInfo &info);
+  Napi::Value Errors(const Napi::CallbackInfo &info);
+  Napi::Value Close(const Napi::CallbackInfo &info);
+
+  void close();
+
+  /// callbacks wrapping the default SAX2 tree builder, context is the
+  /// parser context
+
+  static void start_element_ns(void *context, const xmlChar *localname,
+                               const xmlChar *prefix, const xmlChar *uri,
+                               int nb_namespaces, const xmlChar **namespaces,
+                               int nb_attributes, int nb_defaulted,
+                               const xmlChar **attributes);
+  static void end_element_ns(void *context, const xmlChar *localname,
+                             const xmlChar *prefix, const xmlChar *uri);
+  static void characters(void *context, const xmlChar *ch, int len);
+  static void cdata_block(void *context, const xmlChar *value, int len);
+  static void comment(void *context, const xmlChar *value);
+  static void processing_instruction(void *context, const xmlChar *target,
+                                     const xmlChar *data);
+  static void reference(void *context, const xmlChar *name);
+
+  xmlParserCtxt *context_;
+  std::unique_ptr<XmlSaxFilterState> filter_;
+
+  // records completed by the chunk being pushed
+  std::vector<xmlDoc *> records_;
+
+  std::vector<XmlErrorRecord> errors_;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_RECORD_SPLITTER_H_
@@ -1,9 +1,12 @@
 // Copyright 2009, Squish Tech, LLC.
 
+#include <cstring>
+
 #include <libxml/parserInternals.h>
 
 #include "libxmljs.h"
 
+#include "xml_document.h"
 #include "xml_sax_parser.h"
 
 libxmljs::XmlSaxParser *LXJS_GET_PARSER_FROM_CONTEXT(void *context) {
@@ -15,8 +18,26 @@ libxmljs::XmlSaxParser *LXJS_GET_PARSER_FROM_CONTEXT(void *context) {
 
 namespace libxmljs {
 
+// the bytes of a Buffer / Uint8Array, read in place without a copy
+static bool byte_view(const Napi::Value &value, const char **data,
+                      size_t *length) {
+  if (!value.IsTypedArray() ||
+      value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+    return false;
+  }
+
+  Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+  *data = reinterpret_cast<const char *>(bytes.Data());
+  *length = bytes.ByteLength();
+  return true;
+}
+
 XmlSaxParser::XmlSaxParser(const Napi::CallbackInfo &info)
-    : Napi::ObjectWrap<XmlSaxParser>(info), context_(NULL) {
+    : Napi::ObjectWrap<XmlSaxParser>(info), context_(NULL), pushing_(false),
+      close_pending_(false), schema_ctxt_(NULL), schema_plug_(NULL),
+      interned_hits_(0), interned_misses_(0), batch_max_events_(0),
+      batch_max_bytes_(0),
+      attribute_format_(ATTRIBUTES_ARRAYS) {
   xmlSAXHandler tmp = {
       0, // internalSubset;
       0, // isStandalone;
@@ -69,6 +90,9 @@ void XmlSaxParser::initializeContext() {
 }
 
 void XmlSaxParser::releaseContext() {
+  // the plug owns the SAX handler the context points at, undo it first
+  unplugSchema();
+
   if (context_) {
     context_->_private = 0;
 
@@ -88,6 +112,10 @@ void XmlSaxParser::releaseContext() {
     xmlFreeParserCtxt(context_);
     context_ = 0;
   }
+
+  // the dictionary went away with the context, its pointers may be reused
+  interned_.clear();
+  interned_strings_.Reset();
 }
 
 void XmlSaxParser::Callback(const char *what, int argc, Napi::Value *argv) {
@@ -114,25 +142,472 @@ void XmlSaxParser::Callback(const char *what, int argc, Napi::Value *argv) {
   emit_fn.Call(self, args);
 }
 
+// bytes of the well-formed UTF-8 sequence at str, 0 if it is not one
+static size_t utf8_sequence_size(const xmlChar *str, size_t size) {
+  const xmlChar lead = str[0];
+  size_t needed;
+  xmlChar min = 0x80;
+  xmlChar max = 0xBF;
+
+  if (lead < 0x80) {
+    return 1;
+  } else if (lead >= 0xC2 && lead <= 0xDF) {
+    needed = 2;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    needed = 3;
+    // no overlong forms and no surrogates
+    if (lead == 0xE0) {
+      min = 0xA0;
+    } else if (lead == 0xED) {
+      max = 0x9F;
+    }
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    needed = 4;
+    // no overlong forms and nothing above U+10FFFF
+    if (lead == 0xF0) {
+      min = 0x90;
+    } else if (lead == 0xF4) {
+      max = 0x8F;
+    }
+  } else {
+    return 0;
+  }
+
+  if (size < needed || str[1] < min || str[1] > max) {
+    return 0;
+  }
+  for (size_t i = 2; i < needed; ++i) {
+    if ((str[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+  }
+  return needed;
+}
+
+void XmlSaxBatch::add_string(const xmlChar *str, int len) {
+  static const char replacement[] = "\xEF\xBF\xBD";
+
+  if (str == NULL) {
+    ops.push_back(0);
+    ops.push_back(null_string);
+    return;
+  }
+
+  size_t size = len < 0 ? strlen((const char *)str) : (size_t)len;
+
+  // code points outside the BMP take a surrogate pair. A byte that does not
+  // start a well-formed sequence is stored as U+FFFD, so the lengths match
+  // the string V8 decodes from text.
+  uint32_t length = 0;
+  size_t copied = 0;
+  size_t i = 0;
+  while (i < size) {
+    size_t sequence = utf8_sequence_size(str + i, size - i);
+    if (sequence == 0) {
+      text.append((const char *)str + copied, i - copied);
+      text.append(replacement, 3);
+      length += 1;
+      i += 1;
+      copied = i;
+      continue;
+    }
+    length += sequence == 4 ? 2 : 1;
+    i += sequence;
+  }
+
+  ops.push_back(text_length);
+  ops.push_back(length);
+  text.append((const char *)str + copied, size - copied);
+  text_length += length;
+}
+
+void XmlSaxBatch::add_start_element_ns(
+    const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri,
+    int nb_namespaces, const xmlChar **namespaces, int nb_attributes,
+    const xmlChar **attributes) {
+  static const xmlChar empty[] = "";
+
+  add_event(SAX_START_ELEMENT_NS);
+  add_string(localname);
+  add_string(prefix);
+  add_string(uri);
+  add_value(attributes ? nb_attributes : 0);
+  add_value(namespaces ? nb_namespaces : 0);
+
+  // same shape as the startElementNS event: missing attribute prefixes and
+  // URIs are empty strings, a default namespace has a null prefix
+  if (attributes) {
+    for (int i = 0, j = 0; j < nb_attributes; i += 5, j++) {
+      add_string(attributes[i + 0]);
+      add_string(attributes[i + 1] ? attributes[i + 1] : empty);
+      add_string(attributes[i + 2] ? attributes[i + 2] : empty);
+      add_string(attributes[i + 3], attributes[i + 4] - attributes[i + 3]);
+    }
+  }
+
+  if (namespaces) {
+    for (int i = 0, j = 0; j < nb_namespaces; i += 2, j++) {
+      add_string(xmlStrlen(namespaces[i]) == 0 ? NULL : namespaces[i]);
+      add_string(namespaces[i + 1] ? namespaces[i + 1] : empty);
+    }
+  }
+}
+
+Napi::Uint32Array XmlSaxBatch::js_ops(Napi::Env env) const {
+  Napi::Uint32Array array = Napi::Uint32Array::New(env, ops.size());
+  memcpy(array.Data(), ops.data(), ops.size() * sizeof(uint32_t));
+  return array;
+}
+
+Napi::String XmlSaxBatch::js_text(Napi::Env env) const {
+  return Napi::String::New(env, text.data(), text.size());
+}
+
+void XmlSaxBatch::clear() {
+  ops.clear();
+  text.clear();
+  text_length = 0;
+  events = 0;
+}
+
+// strings of a filter spec entry, either a single string or an array
+static bool filter_strings(Napi::Value value, std::vector<std::string> *out) {
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
+  }
+  if (value.IsString()) {
+    out->push_back(value.As<Napi::String>().Utf8Value());
+    return true;
+  }
+  if (!value.IsArray()) {
+    return false;
+  }
+
+  Napi::Array array = value.As<Napi::Array>();
+  for (uint32_t i = 0; i < array.Length(); ++i) {
+    Napi::Value item = array.Get(i);
+    if (!item.IsString()) {
+      return false;
+    }
+    out->push_back(item.As<Napi::String>().Utf8Value());
+  }
+  return true;
+}
+
+XmlSaxFilter::~XmlSaxFilter() {
+  for (xmlPattern *pattern : patterns) {
+    xmlFreePattern(pattern);
+  }
+}
+
+XmlSaxFilterPtr XmlSaxFilter::Compile(Napi::Env env, Napi::Object spec) {
+  std::vector<std::string> names, uris, sources;
+  if (!filter_strings(spec.Get("names"), &names) ||
+      !filter_strings(spec.Get("uris"), &uris) ||
+      !filter_strings(spec.Get("patterns"), &sources)) {
+    Napi::TypeError::New(env, "Bad Argument: filter names, uris and patterns "
+                              "must be strings or arrays of strings")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  // prefixes the patterns may use, as [uri, prefix, ..., NULL, NULL]
+  std::vector<std::string> bindings;
+  Napi::Value namespaces = spec.Get("namespaces");
+  if (namespaces.IsObject()) {
+    Napi::Object map = namespaces.As<Napi::Object>();
+    Napi::Array prefixes = map.GetPropertyNames();
+    for (uint32_t i = 0; i < prefixes.Length(); ++i) {
+      Napi::Value prefix = prefixes.Get(i);
+      bindings.push_back(map.Get(prefix).ToString().Utf8Value());
+      bindings.push_back(prefix.ToString().Utf8Value());
+    }
+  }
+  std::vector<const xmlChar *> ns_array;
+  for (const std::string &binding : bindings) {
+    ns_array.push_back((const xmlChar *)binding.c_str());
+  }
+  ns_array.push_back(NULL);
+  ns_array.push_back(NULL);
+
+  std::shared_ptr<XmlSaxFilter> filter = std::make_shared<XmlSaxFilter>();
+  filter->names.insert(names.begin(), names.end());
+  filter->uris.insert(uris.begin(), uris.end());
+
+  for (const std::string &source : sources) {
+    xmlPattern *pattern = xmlPatterncompile((const xmlChar *)source.c_str(),
+                                            NULL, 0, ns_array.data());
+    if (pattern == NULL) {
+      Napi::Error::New(env, "Invalid filter pattern: " + source)
+          .ThrowAsJavaScriptException();
+      return nullptr;
+    }
+    filter->patterns.push_back(pattern);
+
+    if (xmlPatternStreamable(pattern) != 1) {
+      Napi::Error::New(env, "Filter pattern can not be streamed: " + source)
+          .ThrowAsJavaScriptException();
+      return nullptr;
+    }
+  }
+
+  return filter;
+}
+
+XmlSaxFilterState::XmlSaxFilterState(XmlSaxFilterPtr filter)
+    : filter(filter), depth_(0), selected_depth_(0) {
+  begin();
+}
+
+XmlSaxFilterState::~XmlSaxFilterState() { free_streams(); }
+
+void XmlSaxFilterState::free_streams() {
+  for (xmlStreamCtxt *stream : streams_) {
+    xmlFreeStreamCtxt(stream);
+  }
+  streams_.clear();
+}
+
+void XmlSaxFilterState::begin() {
+  free_streams();
+  for (xmlPattern *pattern : filter->patterns) {
+    xmlStreamCtxt *stream = xmlPatternGetStreamCtxt(pattern);
+    if (stream != NULL) {
+      streams_.push_back(stream);
+    }
+  }
+  depth_ = 0;
+  selected_depth_ = 0;
+}
+
+bool XmlSaxFilterState::enter(const xmlChar *localname, const xmlChar *uri) {
+  ++depth_;
+
+  // the streams follow every element, selected or not
+  bool matched = false;
+  for (xmlStreamCtxt *stream : streams_) {
+    if (xmlStreamPush(stream, localname, uri) == 1) {
+      matched = true;
+    }
+  }
+
+  if (selected_depth_ > 0) {
+    return true;
+  }
+
+  if (matched ||
+      (!filter->names.empty() &&
+       filter->names.count((const char *)localname) > 0) ||
+      (uri != NULL && !filter->uris.empty() &&
+       filter->uris.count((const char *)uri) > 0)) {
+    selected_depth_ = depth_;
+    return true;
+  }
+
+  return false;
+}
+
+bool XmlSaxFilterState::leave() {
+  // an element that started before the filter was set
+  if (depth_ == 0) {
+    return false;
+  }
+
+  for (xmlStreamCtxt *stream : streams_) {
+    xmlStreamPop(stream);
+  }
+
+  bool report = selected();
+  if (depth_ == selected_depth_) {
+    selected_depth_ = 0;
+  }
+  --depth_;
+
+  return report;
+}
+
+// JS-signature: (callback: Function | null, maxEvents?: number,
+//                maxBytes?: number)
+Napi::Value XmlSaxParser::SetBatchCallback(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
+    // deliver whatever is pending before switching back to events
+    flush_batch();
+    batch_callback_.Reset();
+    return env.Undefined();
+  }
+
+  if (!info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Bad Argument: batch callback must be a function")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  batch_callback_ = Napi::Persistent(info[0].As<Napi::Function>());
+  batch_max_events_ = info.Length() > 1 && info[1].IsNumber()
+                          ? info[1].As<Napi::Number>().Uint32Value()
+                          : 1024;
+  batch_max_bytes_ = info.Length() > 2 && info[2].IsNumber()
+                         ? info[2].As<Napi::Number>().Uint32Value()
+                         : 64 * 1024;
+
+  return env.Undefined();
+}
+
+Napi::String XmlSaxParser::interned_string(Napi::Env env,
+                                           const xmlChar *str) {
+  auto found = interned_.find(str);
+  if (found != interned_.end()) {
+    ++interned_hits_;
+    return interned_strings_.Value().Get(found->second).As<Napi::String>();
+  }
+  ++interned_misses_;
+
+  Napi::String value = Napi::String::New(env, (const char *)str);
+
+  // only names owned by the dictionary keep their address
+  if (context_ != NULL && context_->dict != NULL &&
+      interned_.size() < max_interned &&
+      xmlDictOwns(context_->dict, str) == 1) {
+    if (interned_strings_.IsEmpty()) {
+      interned_strings_ = Napi::Persistent(Napi::Array::New(env));
+    }
+    uint32_t index = static_cast<uint32_t>(interned_.size());
+    interned_strings_.Value().Set(index, value);
+    interned_.emplace(str, index);
+  }
+
+  return value;
+}
+
+Napi::Value XmlSaxParser::InternStats(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("hits", Napi::Number::New(env, (double)interned_hits_));
+  stats.Set("misses", Napi::Number::New(env, (double)interned_misses_));
+  stats.Set("size", Napi::Number::New(env, (double)interned_.size()));
+
+  return stats;
+}
+
+// JS-signature: (filter: { names?, uris?, patterns?, namespaces? } | null)
+Napi::Value XmlSaxParser::SetFilter(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
+    filter_.reset();
+    return env.Undefined();
+  }
+
+  if (!info[0].IsObject()) {
+    Napi::TypeError::New(env, "Bad Argument: filter must be an object")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  XmlSaxFilterPtr filter = XmlSaxFilter::Compile(env, info[0].ToObject());
+  if (filter) {
+    filter_.reset(new XmlSaxFilterState(filter));
+  }
+
+  return env.Undefined();
+}
+
+// JS-signature: (format?: 'arrays' | 'flat' | 'object') => string
+Napi::Value XmlSaxParser::AttributeFormat(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  static const char *names[] = {"arrays", "flat", "object"};
+
+  if (info.Length() > 0 && !info[0].IsUndefined()) {
+    std::string format =
+        info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : "";
+    size_t i = 0;
+    while (i < 3 && format != names[i]) {
+      ++i;
+    }
+    if (i == 3) {
+      Napi::TypeError::New(env, "Bad Argument: attribute format must be "
+                                "'arrays', 'flat' or 'object'")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    attribute_format_ = static_cast<AttributeLayout>(i);
+  }
+
+  return Napi::String::New(env, names[attribute_format_]);
+}
+
+void XmlSaxParser::batch_added() {
+  if (batch_.events >= batch_max_events_ ||
+      batch_.text.size() >= batch_max_bytes_) {
+    flush_batch();
+  }
+}
+
+void XmlSaxParser::flush_batch() {
+  if (batch_.events == 0 || !batching()) {
+    return;
+  }
+
+  Napi::Env env = this->Env();
+  Napi::HandleScope scope(env);
+
+  Napi::Uint32Array ops = batch_.js_ops(env);
+  Napi::String text = batch_.js_text(env);
+
+  // the callback may parse again, start over before calling out
+  batch_.clear();
+
+  batch_callback_.Call(this->Value(), {ops, text});
+}
+
 Napi::Value XmlSaxParser::Push(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
   Napi::EscapableHandleScope scope(env);
 
-  if (info.Length() < 1 || !info[0].IsString()) {
-    Napi::TypeError::New(env, "Bad Argument: parseString requires a string")
+  const char *data = NULL;
+  size_t length = 0;
+  bool bytes = info.Length() > 0 && byte_view(info[0], &data, &length);
+
+  if (!bytes && (info.Length() < 1 || !info[0].IsString())) {
+    Napi::TypeError::New(env,
+                         "Bad Argument: push requires a string or Buffer")
         .ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
 
-  std::string parsable = info[0].ToString().Utf8Value();
-
   bool terminate = info.Length() > 1 ? info[1].ToBoolean().Value() : false;
 
-  this->push(parsable.c_str(), parsable.length(), terminate);
+  // bytes go to libxml as they are, so it detects their encoding itself
+  if (bytes) {
+    this->push(data, length, terminate);
+  } else {
+    Utf8Scratch parsable(info[0].As<Napi::String>());
+    this->push(parsable.data(), parsable.length(), terminate);
+  }
 
   return scope.Escape(Napi::Boolean::New(env, true));
 }
 
+// stop a push parser without terminating the document: nothing more is
+// emitted and the context is freed right away, or once the chunk being
+// parsed returns when called from a listener
+Napi::Value XmlSaxParser::Close(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  batch_.clear();
+  if (pushing_) {
+    xmlStopParser(context_);
+    close_pending_ = true;
+  } else {
+    releaseContext();
+  }
+
+  return env.Undefined();
+}
+
 void XmlSaxParser::initialize_push_parser() {
   context_ = xmlCreatePushParserCtxt(&sax_handler_, NULL, NULL, 0, "");
   initializeContext();
@@ -140,7 +615,22 @@ void XmlSaxParser::initialize_push_parser() {
 }
 
 void XmlSaxParser::push(const char *str, unsigned int size, bool terminate) {
+  pushing_ = true;
   xmlParseChunk(context_, str, size, terminate);
+  pushing_ = false;
+
+  if (close_pending_) {
+    close_pending_ = false;
+    batch_.clear();
+    releaseContext();
+    return;
+  }
+
+  flush_batch();
+
+  if (terminate && schema_plug_) {
+    finish_schema_validation();
+  }
 
   // When parsing is complete, release the context immediately to avoid leaks
   // in environments where GC/destructors may not run promptly
@@ -149,18 +639,127 @@ void XmlSaxParser::push(const char *str, unsigned int size, bool terminate) {
   }
 }
 
+// JS-signature: (xsd: Schema | Document)
+Napi::Value XmlSaxParser::PlugSchema(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::EscapableHandleScope scope(env);
+
+  if (info.Length() == 0 || info[0].IsNull() || info[0].IsUndefined()) {
+    Napi::Error::New(env, "Must pass xsd").ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+
+  if (context_ == NULL || context_->instate != XML_PARSER_START ||
+      schema_plug_ != NULL) {
+    Napi::Error::New(env, "A schema can only be plugged in before parsing")
+        .ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+
+  XmlSchemaCompiledPtr compiled;
+  if (info[0].IsObject() &&
+      info[0].ToObject().InstanceOf(XmlSchema::constructor.Value())) {
+    compiled = XmlSchema::Unwrap(info[0].ToObject())->compiled;
+  } else if (info[0].IsObject() &&
+             info[0].ToObject().InstanceOf(XmlDocument::constructor.Value())) {
+    XmlDocument *documentSchema =
+        Napi::ObjectWrap<XmlDocument>::Unwrap(info[0].ToObject());
+    compiled = XmlSchema::Compile(env, documentSchema->xml_obj, true);
+    if (!compiled) {
+      return scope.Escape(env.Undefined());
+    }
+  } else {
+    Napi::Error::New(env, "Must pass XmlDocument").ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+
+  this->plug_schema(compiled);
+  if (schema_plug_ == NULL) {
+    Napi::Error::New(env,
+                     "Unable to create a validation context for the schema")
+        .ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+
+  return scope.Escape(Napi::Boolean::New(env, true));
+}
+
+void XmlSaxParser::plug_schema(XmlSchemaCompiledPtr compiled) {
+  schema_ctxt_ = xmlSchemaNewValidCtxt(compiled->schema);
+  if (schema_ctxt_ == NULL) {
+    return;
+  }
+
+  // wraps our SAX handler, the callbacks keep receiving the parser context
+  // as user data while the validator sees every event first
+  schema_plug_ =
+      xmlSchemaSAXPlug(schema_ctxt_, &context_->sax, &context_->userData);
+  if (schema_plug_ == NULL) {
+    xmlSchemaFreeValidCtxt(schema_ctxt_);
+    schema_ctxt_ = NULL;
+    return;
+  }
+
+  schema_ = compiled;
+  schema_errors_.clear();
+  xmlSchemaSetValidStructuredErrors(
+      schema_ctxt_, XmlSyntaxError::PushToRecords, &schema_errors_);
+  xmlSchemaValidateSetLocator(schema_ctxt_, XmlSaxParser::schema_locator,
+                              this);
+
+  // the legacy error callbacks would now be handed the plug as user data
+  xmlCtxtSetErrorHandler(context_, XmlSaxParser::structured_error, this);
+}
+
+void XmlSaxParser::unplugSchema() {
+  if (schema_plug_ != NULL) {
+    xmlSchemaSAXUnplug(schema_plug_);
+    schema_plug_ = NULL;
+  }
+  if (schema_ctxt_ != NULL) {
+    xmlSchemaFreeValidCtxt(schema_ctxt_);
+    schema_ctxt_ = NULL;
+  }
+  schema_.reset();
+}
+
+void XmlSaxParser::finish_schema_validation() {
+  Napi::Env env = this->Env();
+  Napi::HandleScope scope(env);
+
+  bool valid = context_->wellFormed && xmlSchemaIsValid(schema_ctxt_) == 1;
+
+  Napi::Value argv[2] = {
+      Napi::Boolean::New(env, valid),
+      XmlSyntaxError::BuildSyntaxErrors(env, schema_errors_)};
+
+  schema_errors_.clear();
+  unplugSchema();
+
+  this->Callback("validated", 2, argv);
+}
+
 Napi::Value XmlSaxParser::ParseString(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
   Napi::EscapableHandleScope scope(env);
 
-  if (info.Length() < 1 || !info[0].IsString()) {
-    Napi::TypeError::New(env, "Bad Argument: parseString requires a string")
+  const char *data = NULL;
+  size_t length = 0;
+  bool bytes = info.Length() > 0 && byte_view(info[0], &data, &length);
+
+  if (!bytes && (info.Length() < 1 || !info[0].IsString())) {
+    Napi::TypeError::New(
+        env, "Bad Argument: parseString requires a string or Buffer")
         .ThrowAsJavaScriptException();
     return scope.Escape(env.Undefined());
   }
 
-  std::string parsable = info[0].As<Napi::String>().Utf8Value();
-  this->parse_string(parsable.c_str(), parsable.length());
+  if (bytes) {
+    this->parse_string(data, length);
+  } else {
+    Utf8Scratch parsable(info[0].As<Napi::String>());
+    this->parse_string(parsable.data(), parsable.length());
+  }
 
   // TODO(sprsquish): return based on the parser
   return scope.Escape(Napi::Boolean::New(env, true));
@@ -169,23 +768,35 @@ Napi::Value XmlSaxParser::ParseString(const Napi::CallbackInfo &info) {
 void XmlSaxParser::parse_string(const char *str, unsigned int size) {
   this->releaseContext();
 
-  context_ = xmlCreateMemoryParserCtxt(str, size);
+  // xmlCtxtReadMemory reads straight from str instead of copying it into an
+  // input buffer first, replaceEntities is set through XML_PARSE_NOENT
+  context_ = xmlNewSAXParserCtxt(&sax_handler_, NULL);
   initializeContext();
-  context_->replaceEntities = 1;
-  xmlSAXHandler *old_sax = context_->sax;
-  context_->sax = &sax_handler_;
-  xmlParseDocument(context_);
-  context_->sax = old_sax;
+  xmlCtxtReadMemory(context_, str, size, NULL, NULL, XML_PARSE_NOENT);
   releaseContext();
+  flush_batch();
 }
 
 void XmlSaxParser::start_document(void *context) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->filter_) {
+    parser->filter_->begin();
+  }
+  if (parser->batching()) {
+    parser->batch_.add_event(XmlSaxBatch::SAX_START_DOCUMENT);
+    parser->batch_added();
+    return;
+  }
   parser->Callback("startDocument");
 }
 
 void XmlSaxParser::end_document(void *context) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->batching()) {
+    parser->batch_.add_event(XmlSaxBatch::SAX_END_DOCUMENT);
+    parser->batch_added();
+    return;
+  }
   parser->Callback("endDocument");
 }
 
@@ -196,100 +807,181 @@ void XmlSaxParser::start_element_ns(void *context, const xmlChar *localname,
                                     int nb_attributes, int nb_defaulted,
                                     const xmlChar **attributes) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->filter_ && !parser->filter_->enter(localname, uri)) {
+    return;
+  }
+  if (parser->batching()) {
+    parser->batch_.add_start_element_ns(localname, prefix, uri,
+                                        nb_namespaces, namespaces,
+                                        nb_attributes, attributes);
+    parser->batch_added();
+    return;
+  }
+
   Napi::Env env = parser->Env();
   Napi::HandleScope scope(env);
 
   const int argc = 5;
-  const xmlChar *nsPref, *nsUri, *attrLocal, *attrPref, *attrUri, *attrVal;
-  int i, j;
-
-  Napi::Array elem;
 
   // Initialize argv with localname, prefix, and uri
   Napi::Value argv[argc];
-  argv[0] = Napi::String::New(env, (const char *)localname);
-
-  // Build attributes list
-  // Each attribute is an array of [localname, prefix, URI, value, end]
-  Napi::Array attrList = Napi::Array::New(env, nb_attributes);
-  if (attributes) {
-    for (i = 0, j = 0; j < nb_attributes; i += 5, j++) {
-      attrLocal = attributes[i + 0];
-      attrPref = attributes[i + 1];
-      attrUri = attributes[i + 2];
-      attrVal = attributes[i + 3];
-
-      elem = Napi::Array::New(env, 4);
-
-      elem.Set(0u, Napi::String::New(env, (const char *)attrLocal,
-                                     xmlStrlen(attrLocal)));
-      elem.Set(1u, Napi::String::New(env, (const char *)attrPref,
-                                     xmlStrlen(attrPref)));
-      elem.Set(2u, Napi::String::New(env, (const char *)attrUri,
-                                     xmlStrlen(attrUri)));
-      elem.Set(3u, Napi::String::New(env, (const char *)attrVal,
-                                     attributes[i + 4] - attrVal));
-
-      attrList.Set(j, elem);
-    }
-  }
-  argv[1] = attrList;
+  argv[0] = parser->interned_string(env, localname);
+  argv[1] = parser->attributes_value(env, nb_attributes, attributes);
 
   if (prefix) {
-    argv[2] = Napi::String::New(env, (const char *)prefix);
+    argv[2] = parser->interned_string(env, prefix);
   } else {
     argv[2] = env.Null();
   }
 
   if (uri) {
-    argv[3] = Napi::String::New(env, (const char *)uri);
+    argv[3] = parser->interned_string(env, uri);
   } else {
     argv[3] = env.Null();
   }
 
-  // Build namespace array of arrays [[prefix, ns], [prefix, ns]]
-  Napi::Array nsList = Napi::Array::New(env, nb_namespaces);
-  if (namespaces) {
-    for (i = 0, j = 0; j < nb_namespaces; j++) {
-      nsPref = namespaces[i++];
-      nsUri = namespaces[i++];
+  argv[4] = parser->namespaces_value(env, nb_namespaces, namespaces);
+
+  parser->Callback("startElementNS", argc, argv);
+}
 
-      elem = Napi::Array::New(env, 2);
-      if (xmlStrlen(nsPref) == 0) {
-        elem.Set(0u, env.Null());
+Napi::Value XmlSaxParser::attributes_value(Napi::Env env, int nb_attributes,
+                                           const xmlChar **attributes) {
+  if (attributes == NULL) {
+    nb_attributes = 0;
+  }
+
+  // attributes holds 5 pointers per attribute:
+  // localname, prefix, URI, value and end of value
+  if (attribute_format_ == ATTRIBUTES_OBJECT) {
+    Napi::Object object = Napi::Object::New(env);
+    for (int i = 0; i < nb_attributes * 5; i += 5) {
+      Napi::Value value =
+          Napi::String::New(env, (const char *)attributes[i + 3],
+                            attributes[i + 4] - attributes[i + 3]);
+      if (attributes[i + 1] == NULL) {
+        object.Set(interned_string(env, attributes[i]), value);
       } else {
-        elem.Set(0u, Napi::String::New(env, (const char *)nsPref,
-                                       xmlStrlen(nsPref)));
+        std::string name = (const char *)attributes[i + 1];
+        name += ':';
+        name += (const char *)attributes[i];
+        object.Set(name, value);
       }
+    }
+    return object;
+  }
 
-      elem.Set(1u,
-               Napi::String::New(env, (const char *)nsUri, xmlStrlen(nsUri)));
+  Napi::String empty = Napi::String::New(env, "");
+
+  if (attribute_format_ == ATTRIBUTES_FLAT) {
+    Napi::Array flat = Napi::Array::New(env, nb_attributes * 4);
+    for (int i = 0, j = 0; j < nb_attributes * 4; i += 5, j += 4) {
+      flat.Set(j, interned_string(env, attributes[i]));
+      flat.Set(j + 1, attributes[i + 1]
+                          ? interned_string(env, attributes[i + 1])
+                          : empty);
+      flat.Set(j + 2, attributes[i + 2]
+                          ? interned_string(env, attributes[i + 2])
+                          : empty);
+      flat.Set(j + 3, Napi::String::New(env, (const char *)attributes[i + 3],
+                                        attributes[i + 4] - attributes[i + 3]));
+    }
+    return flat;
+  }
 
-      nsList.Set(j, elem);
+  // Each attribute is an array of [localname, prefix, URI, value]
+  Napi::Array list = Napi::Array::New(env, nb_attributes);
+  for (int i = 0, j = 0; j < nb_attributes; i += 5, j++) {
+    Napi::Array elem = Napi::Array::New(env, 4);
+
+    elem.Set(0u, interned_string(env, attributes[i]));
+    elem.Set(1u, attributes[i + 1] ? interned_string(env, attributes[i + 1])
+                                   : empty);
+    elem.Set(2u, attributes[i + 2] ? interned_string(env, attributes[i + 2])
+                                   : empty);
+    elem.Set(3u, Napi::String::New(env, (const char *)attributes[i + 3],
+                                   attributes[i + 4] - attributes[i + 3]));
+
+    list.Set(j, elem);
+  }
+  return list;
+}
+
+Napi::Value XmlSaxParser::namespaces_value(Napi::Env env, int nb_namespaces,
+                                           const xmlChar **namespaces) {
+  if (namespaces == NULL) {
+    nb_namespaces = 0;
+  }
+
+  // namespaces holds prefix / URI pairs, the default namespace has an
+  // empty or NULL prefix
+  Napi::String empty = Napi::String::New(env, "");
+
+  if (attribute_format_ == ATTRIBUTES_OBJECT) {
+    Napi::Object object = Napi::Object::New(env);
+    for (int i = 0; i < nb_namespaces * 2; i += 2) {
+      object.Set(xmlStrlen(namespaces[i]) == 0
+                     ? empty
+                     : interned_string(env, namespaces[i]),
+                 namespaces[i + 1] ? interned_string(env, namespaces[i + 1])
+                                   : empty);
     }
+    return object;
   }
-  argv[4] = nsList;
 
-  parser->Callback("startElementNS", argc, argv);
+  Napi::Array list = Napi::Array::New(
+      env, attribute_format_ == ATTRIBUTES_FLAT ? nb_namespaces * 2
+                                                : nb_namespaces);
+  for (int i = 0, j = 0; j < nb_namespaces; i += 2, j++) {
+    Napi::Value ns_prefix = xmlStrlen(namespaces[i]) == 0
+                                ? env.Null()
+                                : interned_string(env, namespaces[i]);
+    Napi::Value ns_uri =
+        namespaces[i + 1] ? interned_string(env, namespaces[i + 1]) : empty;
+
+    if (attribute_format_ == ATTRIBUTES_FLAT) {
+      list.Set(i, ns_prefix);
+      list.Set(i + 1, ns_uri);
+    } else {
+      // [prefix, ns]
+      Napi::Array elem = Napi::Array::New(env, 2);
+      elem.Set(0u, ns_prefix);
+      elem.Set(1u, ns_uri);
+      list.Set(j, elem);
+    }
+  }
+  return list;
 }
 
 void XmlSaxParser::end_element_ns(void *context, const xmlChar *localname,
                                   const xmlChar *prefix, const xmlChar *uri) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->filter_ && !parser->filter_->leave()) {
+    return;
+  }
+  if (parser->batching()) {
+    parser->batch_.add_event(XmlSaxBatch::SAX_END_ELEMENT_NS);
+    parser->batch_.add_string(localname);
+    parser->batch_.add_string(prefix);
+    parser->batch_.add_string(uri);
+    parser->batch_added();
+    return;
+  }
+
   Napi::Env env = parser->Env();
   Napi::HandleScope scope(env);
 
   Napi::Value argv[3];
-  argv[0] = Napi::String::New(env, (const char *)localname);
+  argv[0] = parser->interned_string(env, localname);
 
   if (prefix) {
-    argv[1] = Napi::String::New(env, (const char *)prefix);
+    argv[1] = parser->interned_string(env, prefix);
   } else {
     argv[1] = env.Null();
   }
 
   if (uri) {
-    argv[2] = Napi::String::New(env, (const char *)uri);
+    argv[2] = parser->interned_string(env, uri);
   } else {
     argv[2] = env.Null();
   }
@@ -299,6 +991,16 @@ void XmlSaxParser::end_element_ns(void *context, const xmlChar *localname,
 
 void XmlSaxParser::characters(void *context, const xmlChar *ch, int len) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->filter_ && !parser->filter_->selected()) {
+    return;
+  }
+  if (parser->batching()) {
+    parser->batch_.add_event(XmlSaxBatch::SAX_CHARACTERS);
+    parser->batch_.add_string(ch, len);
+    parser->batch_added();
+    return;
+  }
+
   Napi::Env env = parser->Env();
   Napi::HandleScope scope(env);
 
@@ -308,6 +1010,16 @@ void XmlSaxParser::characters(void *context, const xmlChar *ch, int len) {
 
 void XmlSaxParser::comment(void *context, const xmlChar *value) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->filter_ && !parser->filter_->selected()) {
+    return;
+  }
+  if (parser->batching()) {
+    parser->batch_.add_event(XmlSaxBatch::SAX_COMMENT);
+    parser->batch_.add_string(value);
+    parser->batch_added();
+    return;
+  }
+
   Napi::Env env = parser->Env();
   Napi::HandleScope scope(env);
 
@@ -317,6 +1029,16 @@ void XmlSaxParser::comment(void *context, const xmlChar *value) {
 
 void XmlSaxParser::cdata_block(void *context, const xmlChar *value, int len) {
   libxmljs::XmlSaxParser *parser = LXJS_GET_PARSER_FROM_CONTEXT(context);
+  if (parser->filter_ && !parser->filter_->selected()) {
+    return;
+  }
+  if (parser->batching()) {
+    parser->batch_.add_event(XmlSaxBatch::SAX_CDATA);
+    parser->batch_.add_string(value, len);
+    parser->batch_added();
+    return;
+  }
+
   Napi::Env env = parser->Env();
   Napi::HandleScope scope(env);
 
@@ -362,8 +1084,14 @@ void XmlSaxParser::warning(void *context, const char *msg, ...) {
   va_list args;
   va_start(args, msg);
   if (vasprintf(&message, msg, args) >= 0) {
-    Napi::Value argv[1] = {Napi::String::New(env, (const char *)message)};
-    parser->Callback("warning", 1, argv);
+    if (parser->batching()) {
+      parser->batch_.add_event(XmlSaxBatch::SAX_WARNING);
+      parser->batch_.add_string((const xmlChar *)message);
+      parser->batch_added();
+    } else {
+      Napi::Value argv[1] = {Napi::String::New(env, (const char *)message)};
+      parser->Callback("warning", 1, argv);
+    }
   }
 
   va_end(args);
@@ -380,14 +1108,310 @@ void XmlSaxParser::error(void *context, const char *msg, ...) {
   va_list args;
   va_start(args, msg);
   if (vasprintf(&message, msg, args) >= 0) {
-    Napi::Value argv[1] = {Napi::String::New(env, (const char *)message)};
-    parser->Callback("error", 1, argv);
+    if (parser->batching()) {
+      parser->batch_.add_event(XmlSaxBatch::SAX_ERROR);
+      parser->batch_.add_string((const xmlChar *)message);
+      parser->batch_added();
+    } else {
+      Napi::Value argv[1] = {Napi::String::New(env, (const char *)message)};
+      parser->Callback("error", 1, argv);
+    }
   }
 
   va_end(args);
   free(message);
 }
 
+void XmlSaxParser::structured_error(void *context, const xmlError *error) {
+  libxmljs::XmlSaxParser *parser =
+      static_cast<libxmljs::XmlSaxParser *>(context);
+  Napi::Env env = parser->Env();
+  Napi::HandleScope scope(env);
+
+  // malformed input also makes the document invalid
+  XmlSyntaxError::PushToRecords(&parser->schema_errors_, error);
+
+  const char *message = error->message ? error->message : "";
+  bool warning = error->level == XML_ERR_WARNING;
+
+  if (parser->batching()) {
+    parser->batch_.add_event(warning ? XmlSaxBatch::SAX_WARNING
+                                     : XmlSaxBatch::SAX_ERROR);
+    parser->batch_.add_string((const xmlChar *)message);
+    parser->batch_added();
+    return;
+  }
+
+  Napi::Value argv[1] = {Napi::String::New(env, message)};
+  parser->Callback(warning ? "warning" : "error", 1, argv);
+}
+
+int XmlSaxParser::schema_locator(void *context, const char **file,
+                                 unsigned long *line) {
+  libxmljs::XmlSaxParser *parser =
+      static_cast<libxmljs::XmlSaxParser *>(context);
+  xmlParserCtxt *ctxt = parser->context_;
+
+  if (ctxt == NULL || ctxt->input == NULL) {
+    return -1;
+  }
+  if (file != NULL) {
+    *file = ctxt->input->filename;
+  }
+  if (line != NULL) {
+    *line = ctxt->input->line;
+  }
+  return 0;
+}
+
+// JS-signature: (str: string, callback: (ops, text) => void,
+//                maxEvents?: number, maxBytes?: number) => Promise
+Napi::Value XmlSaxParser::ParseStringAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  const char *data = NULL;
+  size_t length = 0;
+  bool bytes = info.Length() > 0 && byte_view(info[0], &data, &length);
+
+  if (info.Length() < 2 || !(bytes || info[0].IsString()) ||
+      !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Bad Argument: parseStringAsync requires a "
+                              "string or Buffer and a batch callback")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  size_t max_events = info.Length() > 2 && info[2].IsNumber()
+                          ? info[2].As<Napi::Number>().Uint32Value()
+                          : 1024;
+  size_t max_bytes = info.Length() > 3 && info[3].IsNumber()
+                         ? info[3].As<Napi::Number>().Uint32Value()
+                         : 64 * 1024;
+
+  // the parser thread works on a copy, JS may change the bytes meanwhile
+  std::string input = bytes ? std::string(data, length)
+                            : info[0].As<Napi::String>().Utf8Value();
+
+  return XmlSaxParseTask::Start(env, std::move(input),
+                                info[1].As<Napi::Function>(), max_events,
+                                max_bytes,
+                                filter_ ? filter_->filter : nullptr);
+}
+
+// batches waiting for the JS thread before the parser thread blocks
+static const size_t max_queued_batches = 4;
+
+XmlSaxParseTask::XmlSaxParseTask(Napi::Env env, std::string input,
+                                 size_t max_events, size_t max_bytes,
+                                 XmlSaxFilterPtr filter)
+    : input(std::move(input)), max_events(max_events), max_bytes(max_bytes),
+      filter(filter ? new XmlSaxFilterState(filter) : NULL), ctxt(NULL),
+      aborted(false), deferred(Napi::Promise::Deferred::New(env)) {}
+
+Napi::Promise XmlSaxParseTask::Start(Napi::Env env, std::string input,
+                                     Napi::Function callback,
+                                     size_t max_events, size_t max_bytes,
+                                     XmlSaxFilterPtr filter) {
+  XmlSaxParseTask *task = new XmlSaxParseTask(env, std::move(input),
+                                              max_events, max_bytes, filter);
+  Napi::Promise promise = task->deferred.Promise();
+
+  task->tsfn = Napi::ThreadSafeFunction::New(
+      env, callback, "SaxParseTask", max_queued_batches, 1, task,
+      XmlSaxParseTask::Finalize);
+  task->thread = std::thread(&XmlSaxParseTask::run, task);
+
+  return promise;
+}
+
+// runs on the JS thread once the parser thread released the function and
+// all of its batches were delivered
+void XmlSaxParseTask::Finalize(Napi::Env env, XmlSaxParseTask *task) {
+  task->thread.join();
+
+  if (!task->exception.IsEmpty()) {
+    task->deferred.Reject(task->exception.Value());
+  } else {
+    task->deferred.Resolve(Napi::Boolean::New(env, true));
+  }
+
+  delete task;
+}
+
+void XmlSaxParseTask::run() {
+  xmlSAXHandler sax_handler;
+  memset(&sax_handler, 0, sizeof(sax_handler));
+  sax_handler.startDocument = XmlSaxParseTask::start_document;
+  sax_handler.endDocument = XmlSaxParseTask::end_document;
+  sax_handler.characters = XmlSaxParseTask::characters;
+  sax_handler.comment = XmlSaxParseTask::comment;
+  sax_handler.warning = XmlSaxParseTask::warning;
+  sax_handler.error = XmlSaxParseTask::error;
+  sax_handler.cdataBlock = XmlSaxParseTask::cdata_block;
+  sax_handler.initialized = XML_SAX2_MAGIC;
+  sax_handler.startElementNs = XmlSaxParseTask::start_element_ns;
+  sax_handler.endElementNs = XmlSaxParseTask::end_element_ns;
+
+  // the task is handed to the callbacks as user data
+  ctxt = xmlNewSAXParserCtxt(&sax_handler, this);
+  if (ctxt != NULL) {
+    xmlDoc *doc = xmlCtxtReadMemory(ctxt, input.data(), input.size(), NULL,
+                                    NULL, XML_PARSE_NOENT);
+    if (doc != NULL) {
+      xmlFreeDoc(doc);
+    }
+    xmlFreeParserCtxt(ctxt);
+    ctxt = NULL;
+  }
+
+  flush();
+  tsfn.Release();
+}
+
+void XmlSaxParseTask::added() {
+  if (batch.events >= max_events || batch.text.size() >= max_bytes) {
+    flush();
+  }
+  if (aborted && ctxt != NULL) {
+    xmlStopParser(ctxt);
+  }
+}
+
+void XmlSaxParseTask::flush() {
+  if (batch.events == 0 || aborted) {
+    batch.clear();
+    return;
+  }
+
+  XmlSaxBatch *pending = new XmlSaxBatch(std::move(batch));
+  batch.clear();
+
+  XmlSaxParseTask *task = this;
+  napi_status status = tsfn.BlockingCall(
+      pending,
+      [task](Napi::Env env, Napi::Function callback, XmlSaxBatch *data) {
+        // env is gone when the environment shuts down with batches queued
+        if (env != nullptr && callback != nullptr &&
+            task->exception.IsEmpty()) {
+          try {
+            callback.Call({data->js_ops(env), data->js_text(env)});
+          } catch (const Napi::Error &e) {
+            task->exception = Napi::Persistent(e.Value());
+            task->aborted = true;
+          }
+        }
+        delete data;
+      });
+
+  if (status != napi_ok) {
+    delete pending;
+    aborted = true;
+  }
+}
+
+void XmlSaxParseTask::start_document(void *context) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  if (task->filter) {
+    task->filter->begin();
+  }
+  task->batch.add_event(XmlSaxBatch::SAX_START_DOCUMENT);
+  task->added();
+}
+
+void XmlSaxParseTask::end_document(void *context) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  task->batch.add_event(XmlSaxBatch::SAX_END_DOCUMENT);
+  task->added();
+}
+
+void XmlSaxParseTask::start_element_ns(
+    void *context, const xmlChar *localname, const xmlChar *prefix,
+    const xmlChar *uri, int nb_namespaces, const xmlChar **namespaces,
+    int nb_attributes, int nb_defaulted, const xmlChar **attributes) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  if (task->filter && !task->filter->enter(localname, uri)) {
+    return;
+  }
+  task->batch.add_start_element_ns(localname, prefix, uri, nb_namespaces,
+                                   namespaces, nb_attributes, attributes);
+  task->added();
+}
+
+void XmlSaxParseTask::end_element_ns(void *context, const xmlChar *localname,
+                                     const xmlChar *prefix,
+                                     const xmlChar *uri) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  if (task->filter && !task->filter->leave()) {
+    return;
+  }
+  task->batch.add_event(XmlSaxBatch::SAX_END_ELEMENT_NS);
+  task->batch.add_string(localname);
+  task->batch.add_string(prefix);
+  task->batch.add_string(uri);
+  task->added();
+}
+
+void XmlSaxParseTask::characters(void *context, const xmlChar *ch, int len) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  if (task->filter && !task->filter->selected()) {
+    return;
+  }
+  task->batch.add_event(XmlSaxBatch::SAX_CHARACTERS);
+  task->batch.add_string(ch, len);
+  task->added();
+}
+
+void XmlSaxParseTask::comment(void *context, const xmlChar *value) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  if (task->filter && !task->filter->selected()) {
+    return;
+  }
+  task->batch.add_event(XmlSaxBatch::SAX_COMMENT);
+  task->batch.add_string(value);
+  task->added();
+}
+
+void XmlSaxParseTask::cdata_block(void *context, const xmlChar *value,
+                                  int len) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  if (task->filter && !task->filter->selected()) {
+    return;
+  }
+  task->batch.add_event(XmlSaxBatch::SAX_CDATA);
+  task->batch.add_string(value, len);
+  task->added();
+}
+
+void XmlSaxParseTask::warning(void *context, const char *msg, ...) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  char *message;
+
+  va_list args;
+  va_start(args, msg);
+  if (vasprintf(&message, msg, args) >= 0) {
+    task->batch.add_event(XmlSaxBatch::SAX_WARNING);
+    task->batch.add_string((const xmlChar *)message);
+    free(message);
+    task->added();
+  }
+  va_end(args);
+}
+
+void XmlSaxParseTask::error(void *context, const char *msg, ...) {
+  XmlSaxParseTask *task = static_cast<XmlSaxParseTask *>(context);
+  char *message;
+
+  va_list args;
+  va_start(args, msg);
+  if (vasprintf(&message, msg, args) >= 0) {
+    task->batch.add_event(XmlSaxBatch::SAX_ERROR);
+    task->batch.add_string((const xmlChar *)message);
+    free(message);
+    task->added();
+  }
+  va_end(args);
+}
+
 static void CleanupSaxParserCtxt(void *arg) {
   XmlSaxParserCtxt *data = static_cast<XmlSaxParserCtxt *>(arg);
   delete data;
@@ -399,14 +1423,27 @@ Napi::Value XmlSaxParser::Init(Napi::Env env, Napi::Object exports) {
   XmlSaxParserCtxt *parser_ctx = new XmlSaxParserCtxt{false};
   Napi::Function parser_func = DefineClass(
       env, "SaxParser",
-      {InstanceMethod("parseString", &XmlSaxParser::ParseString)}, parser_ctx);
+      {InstanceMethod("parseString", &XmlSaxParser::ParseString),
+       InstanceMethod("_parseStringAsync", &XmlSaxParser::ParseStringAsync),
+       InstanceMethod("setBatchCallback", &XmlSaxParser::SetBatchCallback),
+       InstanceMethod("internStats", &XmlSaxParser::InternStats),
+       InstanceMethod("setFilter", &XmlSaxParser::SetFilter),
+       InstanceMethod("attributeFormat", &XmlSaxParser::AttributeFormat)},
+      parser_ctx);
 
   exports.Set("SaxParser", parser_func);
 
   // Push Parser - create a separate wrapper that passes true to constructor
   XmlSaxParserCtxt *push_parser_ctx = new XmlSaxParserCtxt{true};
   Napi::Function push_parser_func = DefineClass(
-      env, "SaxPushParser", {InstanceMethod("push", &XmlSaxParser::Push)},
+      env, "SaxPushParser",
+      {InstanceMethod("push", &XmlSaxParser::Push),
+       InstanceMethod("close", &XmlSaxParser::Close),
+       InstanceMethod("plugSchema", &XmlSaxParser::PlugSchema),
+       InstanceMethod("setBatchCallback", &XmlSaxParser::SetBatchCallback),
+       InstanceMethod("internStats", &XmlSaxParser::InternStats),
+       InstanceMethod("setFilter", &XmlSaxParser::SetFilter),
+       InstanceMethod("attributeFormat", &XmlSaxParser::AttributeFormat)},
       push_parser_ctx);
 
   exports.Set("SaxPushParser", push_parser_func);
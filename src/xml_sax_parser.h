@@ -2,17 +2,204 @@
 #ifndef SRC_XML_SAX_PARSER_H_
 #define SRC_XML_SAX_PARSER_H_
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include <libxml/parser.h>
+#include <libxml/pattern.h>
+#include <libxml/xmlschemas.h>
 #include <napi.h>
 
+#include "xml_schema.h"
+#include "xml_syntax_error.h"
+
 namespace libxmljs {
 
 struct XmlSaxParserCtxt {
   bool is_push_parser;
 };
 
+// SAX events collected natively while batching is enabled. ops holds one
+// record per event: the event type followed by its fields. Strings are
+// stored as (offset, length) pairs into text, counted in UTF-16 code units
+// so the JS side can slice them straight out of one string.
+struct XmlSaxBatch {
+  enum EventType {
+    SAX_START_DOCUMENT = 1,
+    SAX_END_DOCUMENT,
+    SAX_START_ELEMENT_NS,
+    SAX_END_ELEMENT_NS,
+    SAX_CHARACTERS,
+    SAX_COMMENT,
+    SAX_CDATA,
+    SAX_WARNING,
+    SAX_ERROR
+  };
+
+  // length of a NULL string
+  static constexpr uint32_t null_string = 0xFFFFFFFF;
+
+  XmlSaxBatch() : text_length(0), events(0) {}
+
+  void add_event(EventType type) {
+    ops.push_back(type);
+    ++events;
+  }
+  void add_value(uint32_t value) { ops.push_back(value); }
+  void add_string(const xmlChar *str, int len = -1);
+  void add_start_element_ns(const xmlChar *localname, const xmlChar *prefix,
+                            const xmlChar *uri, int nb_namespaces,
+                            const xmlChar **namespaces, int nb_attributes,
+                            const xmlChar **attributes);
+  void clear();
+
+  // the arguments handed to a JS batch callback
+  Napi::Uint32Array js_ops(Napi::Env env) const;
+  Napi::String js_text(Napi::Env env) const;
+
+  std::vector<uint32_t> ops;
+  std::string text;
+
+  // length of text in UTF-16 code units
+  uint32_t text_length;
+
+  size_t events;
+};
+
+// Selects the element subtrees a parser reports. An element is selected
+// when its local name is in names, its namespace in uris, or one of the
+// streaming patterns matches it; events outside selected subtrees are
+// dropped before they reach JS. Read only once compiled, so a parser thread
+// can share it.
+struct XmlSaxFilter {
+  XmlSaxFilter() {}
+  ~XmlSaxFilter();
+
+  // build from a { names, uris, patterns, namespaces } spec, throws a JS
+  // exception and returns NULL on failure
+  static std::shared_ptr<const XmlSaxFilter> Compile(Napi::Env env,
+                                                     Napi::Object spec);
+
+  std::unordered_set<std::string> names;
+  std::unordered_set<std::string> uris;
+  std::vector<xmlPattern *> patterns;
+
+private:
+  XmlSaxFilter(const XmlSaxFilter &) = delete;
+  XmlSaxFilter &operator=(const XmlSaxFilter &) = delete;
+};
+
+typedef std::shared_ptr<const XmlSaxFilter> XmlSaxFilterPtr;
+
+// Where a single parse is with respect to a filter
+class XmlSaxFilterState {
+public:
+  explicit XmlSaxFilterState(XmlSaxFilterPtr filter);
+  ~XmlSaxFilterState();
+
+  // start over at the beginning of a document
+  void begin();
+
+  // an element starts or ends, true if its events are to be reported
+  bool enter(const xmlChar *localname, const xmlChar *uri);
+  bool leave();
+
+  // whether content at the current position is to be reported
+  bool selected() const { return selected_depth_ > 0; }
+
+  // whether the current element is the root of a selected subtree
+  bool at_selected_root() const {
+    return selected_depth_ > 0 && depth_ == selected_depth_;
+  }
+
+  const XmlSaxFilterPtr filter;
+
+private:
+  void free_streams();
+
+  std::vector<xmlStreamCtxt *> streams_;
+
+  // element depth, and the depth of the selected subtree (0 if outside)
+  int depth_;
+  int selected_depth_;
+};
+
+// Tokenizes a string on a thread of its own. Events are collected into
+// batches that are handed to a JS callback through a thread safe function,
+// so tokenizing overlaps with the JS handling of earlier batches. The
+// promise settles once every batch was delivered.
+class XmlSaxParseTask {
+public:
+  static Napi::Promise Start(Napi::Env env, std::string input,
+                             Napi::Function callback, size_t max_events,
+                             size_t max_bytes, XmlSaxFilterPtr filter);
+
+private:
+  XmlSaxParseTask(Napi::Env env, std::string input, size_t max_events,
+                  size_t max_bytes, XmlSaxFilterPtr filter);
+
+  void run();
+
+  // flush once the batch reached its limits, stop once JS failed
+  void added();
+
+  // queue the collected events for the JS thread
+  void flush();
+
+  static void Finalize(Napi::Env env, XmlSaxParseTask *task);
+
+  /// callbacks, context is the task
+
+  static void start_document(void *context);
+  static void end_document(void *context);
+  static void start_element_ns(void *context, const xmlChar *localname,
+                               const xmlChar *prefix, const xmlChar *uri,
+                               int nb_namespaces, const xmlChar **namespaces,
+                               int nb_attributes, int nb_defaulted,
+                               const xmlChar **attributes);
+  static void end_element_ns(void *context, const xmlChar *localname,
+                             const xmlChar *prefix, const xmlChar *uri);
+  static void characters(void *context, const xmlChar *ch, int len);
+  static void comment(void *context, const xmlChar *value);
+  static void cdata_block(void *context, const xmlChar *value, int len);
+  static void warning(void *context, const char *msg, ...);
+  static void error(void *context, const char *msg, ...);
+
+  std::string input;
+  size_t max_events;
+  size_t max_bytes;
+
+  XmlSaxBatch batch;
+  std::unique_ptr<XmlSaxFilterState> filter;
+  xmlParserCtxt *ctxt;
+  std::atomic<bool> aborted;
+
+  std::thread thread;
+  Napi::ThreadSafeFunction tsfn;
+  Napi::Promise::Deferred deferred;
+
+  // first exception thrown by the callback, only used on the JS thread
+  Napi::ObjectReference exception;
+};
+
 class XmlSaxParser : public Napi::ObjectWrap<XmlSaxParser> {
 public:
+  // shape of the attributes and namespaces of a startElementNS event
+  enum AttributeLayout {
+    // [[localname, prefix, uri, value], ...] and [[prefix, uri], ...]
+    ATTRIBUTES_ARRAYS,
+    // [localname, prefix, uri, value, ...] and [prefix, uri, ...]
+    ATTRIBUTES_FLAT,
+    // { qualified name: value } and { prefix or '': uri }
+    ATTRIBUTES_OBJECT
+  };
+
   XmlSaxParser(const Napi::CallbackInfo &info);
   virtual ~XmlSaxParser();
 
@@ -20,15 +207,50 @@ public:
 
   Napi::Value ParseString(const Napi::CallbackInfo &info);
   Napi::Value Push(const Napi::CallbackInfo &info);
+  Napi::Value Close(const Napi::CallbackInfo &info);
+  Napi::Value PlugSchema(const Napi::CallbackInfo &info);
+  Napi::Value SetBatchCallback(const Napi::CallbackInfo &info);
+  Napi::Value ParseStringAsync(const Napi::CallbackInfo &info);
+  Napi::Value InternStats(const Napi::CallbackInfo &info);
+  Napi::Value SetFilter(const Napi::CallbackInfo &info);
+  Napi::Value AttributeFormat(const Napi::CallbackInfo &info);
 
   void Callback(const char *what, int argc = 0, Napi::Value *argv = NULL);
 
+  // whether events are collected into batch_ instead of emitted one by one
+  bool batching() const { return !batch_callback_.IsEmpty(); }
+
+  // flush once the batch reached its limits
+  void batch_added();
+
+  // hand the collected events to the batch callback
+  void flush_batch();
+
+  // JS string for a name libxml interned in the context dictionary. These
+  // are cached by pointer for as long as the context (and so the dictionary)
+  // lives, repeated element and attribute names cost a lookup only.
+  Napi::String interned_string(Napi::Env env, const xmlChar *str);
+
+  // attributes and namespaces of a startElementNS event, shaped according
+  // to attribute_format_
+  Napi::Value attributes_value(Napi::Env env, int nb_attributes,
+                               const xmlChar **attributes);
+  Napi::Value namespaces_value(Napi::Env env, int nb_namespaces,
+                               const xmlChar **namespaces);
+
   void parse_string(const char *str, unsigned int size);
 
   void initialize_push_parser();
 
   void push(const char *str, unsigned int size, bool terminate);
 
+  // validate against compiled while the pushed document streams through,
+  // must be called before the first chunk is pushed
+  void plug_schema(XmlSchemaCompiledPtr compiled);
+
+  // emit the outcome of the streaming validation as a 'validated' event
+  void finish_schema_validation();
+
   /// callbacks
 
   static void start_document(void *context);
@@ -59,12 +281,48 @@ public:
 
   static void error(void *context, const char *msg, ...);
 
+  // error handler used while a schema is plugged in, context is the parser
+  static void structured_error(void *context, const xmlError *error);
+
+  // reports the current input line to the schema validator
+  static int schema_locator(void *context, const char **file,
+                            unsigned long *line);
+
 protected:
   void initializeContext();
   void releaseContext();
+  void unplugSchema();
 
   xmlParserCtxt *context_;
 
+  // xmlParseChunk is on the stack, and close() was called from within it
+  bool pushing_;
+  bool close_pending_;
+
+  XmlSchemaCompiledPtr schema_;
+  xmlSchemaValidCtxt *schema_ctxt_;
+  xmlSchemaSAXPlugStruct *schema_plug_;
+  std::vector<XmlErrorRecord> schema_errors_;
+
+  // position in interned_strings_ by dictionary pointer. Node-API 8 cannot
+  // reference a string, so the strings live in one referenced JS array.
+  std::unordered_map<const xmlChar *, uint32_t> interned_;
+  Napi::ObjectReference interned_strings_;
+  uint64_t interned_hits_;
+  uint64_t interned_misses_;
+
+  // keeps documents with endless distinct names from growing the cache
+  static constexpr size_t max_interned = 4096;
+
+  Napi::FunctionReference batch_callback_;
+  XmlSaxBatch batch_;
+  size_t batch_max_events_;
+  size_t batch_max_bytes_;
+
+  std::unique_ptr<XmlSaxFilterState> filter_;
+
+  AttributeLayout attribute_format_;
+
   xmlSAXHandler sax_handler_;
 };
 
@@ -0,0 +1,281 @@
+// Copyright 2009, Squish Tech, LLC.
+
+#include <vector>
+
+#include "xml_document.h"
+#include "xml_schema.h"
+#include "xml_syntax_error.h"
+
+namespace libxmljs {
+
+XmlSchemaCompiled::XmlSchemaCompiled(xmlSchema *schema, xmlDoc *doc)
+    : schema(schema), doc(doc), shared_id(0) {}
+
+XmlSchemaCompiled::~XmlSchemaCompiled() {
+  if (shared_id != 0) {
+    XmlSharedRegistry<XmlSchemaCompiled>::remove(shared_id);
+  }
+
+  xmlSchemaFree(schema);
+  if (doc != NULL) {
+    xmlFreeDoc(doc);
+  }
+}
+
+Napi::FunctionReference XmlSchema::constructor;
+
+XmlSchemaCompiledPtr XmlSchema::Compile(Napi::Env env, xmlDoc *doc,
+                                        bool copy_doc) {
+  xmlDoc *source = copy_doc ? xmlCopyDoc(doc, 1) : doc;
+  if (source == NULL) {
+    Napi::Error::New(env, "Could not copy schema document")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  xmlSchemaParserCtxtPtr parser_ctxt = xmlSchemaNewDocParserCtxt(source);
+  if (parser_ctxt == NULL) {
+    if (copy_doc) {
+      xmlFreeDoc(source);
+    }
+    Napi::Error::New(env, "Could not create context for schema parser")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  std::vector<XmlErrorRecord> errors;
+  xmlSchemaSetParserStructuredErrors(parser_ctxt, XmlSyntaxError::PushToRecords,
+                                     &errors);
+
+  xmlSchemaPtr schema = xmlSchemaParse(parser_ctxt);
+  xmlSchemaFreeParserCtxt(parser_ctxt);
+
+  if (schema == NULL) {
+    if (copy_doc) {
+      xmlFreeDoc(source);
+    }
+    Napi::Error error = Napi::Error::New(env, "Invalid XSD schema");
+    error.Value().Set("errors",
+                      XmlSyntaxError::BuildSyntaxErrors(env, errors));
+    error.ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  return std::make_shared<XmlSchemaCompiled>(schema,
+                                             copy_doc ? source : NULL);
+}
+
+// JS-signature: (doc: Document | sharedId: number)
+XmlSchema::XmlSchema(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlSchema>(info) {
+  Napi::Env env = info.Env();
+
+  // wrap a grammar shared by another thread
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    compiled = XmlSharedRegistry<XmlSchemaCompiled>::find(
+        info[0].As<Napi::Number>().Uint32Value());
+    if (!compiled) {
+      Napi::Error::New(env, "Shared schema is no longer available")
+          .ThrowAsJavaScriptException();
+    }
+    return;
+  }
+
+  DOCUMENT_ARG_CHECK;
+
+  XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(doc);
+  compiled = XmlSchema::Compile(env, document->xml_obj, true);
+}
+
+Napi::Value XmlSchema::Share(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  return Napi::Number::New(env,
+                           XmlSharedRegistry<XmlSchemaCompiled>::add(compiled));
+}
+
+void XmlSchema::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function ctor =
+      DefineClass(env, "Schema",
+                  {
+                      InstanceMethod("share", &XmlSchema::Share),
+                  });
+
+  constructor = Napi::Persistent(ctor);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("Schema", ctor);
+
+  XmlRelaxNGSchema::Init(env, exports);
+  XmlSchematronSchema::Init(env, exports);
+}
+
+// validation contexts kept around per grammar, enough for a few
+// validations running at the same time
+static const size_t max_pooled_contexts = 4;
+
+XmlRelaxNGCompiled::XmlRelaxNGCompiled(xmlRelaxNG *schema) : schema(schema) {}
+
+XmlRelaxNGCompiled::~XmlRelaxNGCompiled() {
+  for (xmlRelaxNGValidCtxt *valid_ctxt : pool) {
+    xmlRelaxNGFreeValidCtxt(valid_ctxt);
+  }
+  xmlRelaxNGFree(schema);
+}
+
+xmlRelaxNGValidCtxt *XmlRelaxNGCompiled::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pool.empty()) {
+      xmlRelaxNGValidCtxt *valid_ctxt = pool.back();
+      pool.pop_back();
+      return valid_ctxt;
+    }
+  }
+  return xmlRelaxNGNewValidCtxt(schema);
+}
+
+void XmlRelaxNGCompiled::release(xmlRelaxNGValidCtxt *valid_ctxt) {
+  // drop the error handler of the last user before the context is reused
+  xmlRelaxNGSetValidStructuredErrors(valid_ctxt, NULL, NULL);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pool.size() < max_pooled_contexts) {
+      pool.push_back(valid_ctxt);
+      return;
+    }
+  }
+  xmlRelaxNGFreeValidCtxt(valid_ctxt);
+}
+
+Napi::FunctionReference XmlRelaxNGSchema::constructor;
+
+XmlRelaxNGCompiledPtr XmlRelaxNGSchema::Compile(Napi::Env env, xmlDoc *doc) {
+  xmlRelaxNGParserCtxtPtr parser_ctxt = xmlRelaxNGNewDocParserCtxt(doc);
+  if (parser_ctxt == NULL) {
+    Napi::Error::New(env, "Could not create context for RELAX NG schema parser")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  std::vector<XmlErrorRecord> errors;
+  xmlRelaxNGSetParserStructuredErrors(
+      parser_ctxt, XmlSyntaxError::PushToRecords, &errors);
+
+  xmlRelaxNGPtr schema = xmlRelaxNGParse(parser_ctxt);
+  xmlRelaxNGFreeParserCtxt(parser_ctxt);
+
+  if (schema == NULL) {
+    Napi::Error error = Napi::Error::New(env, "Invalid RELAX NG schema");
+    error.Value().Set("errors",
+                      XmlSyntaxError::BuildSyntaxErrors(env, errors));
+    error.ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  return std::make_shared<XmlRelaxNGCompiled>(schema);
+}
+
+// JS-signature: (doc: Document)
+XmlRelaxNGSchema::XmlRelaxNGSchema(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlRelaxNGSchema>(info) {
+  Napi::Env env = info.Env();
+
+  DOCUMENT_ARG_CHECK;
+
+  XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(doc);
+  compiled = XmlRelaxNGSchema::Compile(env, document->xml_obj);
+}
+
+void XmlRelaxNGSchema::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function ctor = DefineClass(env, "RelaxNGSchema", {});
+
+  constructor = Napi::Persistent(ctor);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("RelaxNGSchema", ctor);
+}
+
+XmlSchematronCompiled::XmlSchematronCompiled(xmlSchematron *schema,
+                                             xmlDoc *doc)
+    : schema(schema), doc(doc) {}
+
+XmlSchematronCompiled::~XmlSchematronCompiled() {
+  xmlSchematronFree(schema);
+  if (doc != NULL) {
+    xmlFreeDoc(doc);
+  }
+}
+
+Napi::FunctionReference XmlSchematronSchema::constructor;
+
+XmlSchematronCompiledPtr XmlSchematronSchema::Compile(Napi::Env env,
+                                                      xmlDoc *doc,
+                                                      bool copy_doc) {
+  xmlDoc *source = copy_doc ? xmlCopyDoc(doc, 1) : doc;
+  if (source == NULL) {
+    Napi::Error::New(env, "Could not copy schema document")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  xmlSchematronParserCtxtPtr parser_ctxt =
+      xmlSchematronNewDocParserCtxt(source);
+  if (parser_ctxt == NULL) {
+    if (copy_doc) {
+      xmlFreeDoc(source);
+    }
+    Napi::Error::New(env,
+                     "Could not create context for Schematron schema parser")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  // the Schematron parser has no error handler of its own
+  std::vector<XmlErrorRecord> errors;
+  xmlSetStructuredErrorFunc(&errors, XmlSyntaxError::PushToRecords);
+
+  xmlSchematronPtr schema = xmlSchematronParse(parser_ctxt);
+
+  xmlSetStructuredErrorFunc(NULL, NULL);
+  xmlSchematronFreeParserCtxt(parser_ctxt);
+
+  if (schema == NULL) {
+    if (copy_doc) {
+      xmlFreeDoc(source);
+    }
+    Napi::Error error = Napi::Error::New(env, "Invalid Schematron schema");
+    error.Value().Set("errors",
+                      XmlSyntaxError::BuildSyntaxErrors(env, errors));
+    error.ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  return std::make_shared<XmlSchematronCompiled>(schema,
+                                                 copy_doc ? source : NULL);
+}
+
+// JS-signature: (doc: Document)
+XmlSchematronSchema::XmlSchematronSchema(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlSchematronSchema>(info) {
+  Napi::Env env = info.Env();
+
+  DOCUMENT_ARG_CHECK;
+
+  XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(doc);
+  compiled = XmlSchematronSchema::Compile(env, document->xml_obj, true);
+}
+
+void XmlSchematronSchema::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function ctor = DefineClass(env, "SchematronSchema", {});
+
+  constructor = Napi::Persistent(ctor);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("SchematronSchema", ctor);
+}
+
+} // namespace libxmljs
@@ -0,0 +1,156 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_SCHEMA_H_
+#define SRC_XML_SCHEMA_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <libxml/relaxng.h>
+#include <libxml/schematron.h>
+#include <libxml/tree.h>
+#include <libxml/xmlschemas.h>
+
+#include "libxmljs.h"
+
+namespace libxmljs {
+
+// Process wide table of compiled grammars handed out with #share(), so that
+// other worker threads can wrap the same compiled grammar by id. Only weak
+// references are kept: an id stays valid while some thread still holds it.
+template <class T> class XmlSharedRegistry {
+public:
+  static uint32_t add(const std::shared_ptr<T> &compiled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (compiled->shared_id == 0) {
+      compiled->shared_id = ++next_id;
+      entries[compiled->shared_id] = compiled;
+    }
+    return compiled->shared_id;
+  }
+
+  static std::shared_ptr<T> find(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(id);
+    return found == entries.end() ? nullptr : found->second.lock();
+  }
+
+  static void remove(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(id);
+  }
+
+private:
+  static std::mutex mutex;
+  static std::unordered_map<uint32_t, std::weak_ptr<T>> entries;
+  static uint32_t next_id;
+};
+
+template <class T> std::mutex XmlSharedRegistry<T>::mutex;
+template <class T>
+std::unordered_map<uint32_t, std::weak_ptr<T>> XmlSharedRegistry<T>::entries;
+template <class T> uint32_t XmlSharedRegistry<T>::next_id = 0;
+
+// A compiled XSD. It is read only once built, so a single instance can be
+// used for validation by any number of threads at the same time.
+struct XmlSchemaCompiled {
+  XmlSchemaCompiled(xmlSchema *schema, xmlDoc *doc);
+  ~XmlSchemaCompiled();
+
+  xmlSchema *schema;
+
+  // private copy of the schema document the grammar was built from (if any)
+  xmlDoc *doc;
+
+  // id in the shared registry, 0 if never shared
+  uint32_t shared_id;
+};
+
+typedef std::shared_ptr<XmlSchemaCompiled> XmlSchemaCompiledPtr;
+
+class XmlSchema : public Napi::ObjectWrap<XmlSchema> {
+public:
+  explicit XmlSchema(const Napi::CallbackInfo &info);
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  // compile the XSD held in doc, throws a JS exception and returns NULL
+  // on failure. With copy_doc the grammar keeps a private copy of doc and
+  // does not depend on it afterwards.
+  static XmlSchemaCompiledPtr Compile(Napi::Env env, xmlDoc *doc,
+                                      bool copy_doc);
+
+  XmlSchemaCompiledPtr compiled;
+
+protected:
+  Napi::Value Share(const Napi::CallbackInfo &info);
+};
+
+// A compiled RELAX NG grammar together with a small pool of validation
+// contexts, so repeated validations do not allocate a new context each time
+struct XmlRelaxNGCompiled {
+  explicit XmlRelaxNGCompiled(xmlRelaxNG *schema);
+  ~XmlRelaxNGCompiled();
+
+  // take a validation context from the pool, or create one
+  xmlRelaxNGValidCtxt *acquire();
+
+  // hand a context back once the validation is done
+  void release(xmlRelaxNGValidCtxt *valid_ctxt);
+
+  xmlRelaxNG *schema;
+
+private:
+  std::mutex mutex;
+  std::vector<xmlRelaxNGValidCtxt *> pool;
+};
+
+typedef std::shared_ptr<XmlRelaxNGCompiled> XmlRelaxNGCompiledPtr;
+
+class XmlRelaxNGSchema : public Napi::ObjectWrap<XmlRelaxNGSchema> {
+public:
+  explicit XmlRelaxNGSchema(const Napi::CallbackInfo &info);
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  // compile the RELAX NG grammar held in doc, throws a JS exception and
+  // returns NULL on failure. libxml2 works on its own copy of doc.
+  static XmlRelaxNGCompiledPtr Compile(Napi::Env env, xmlDoc *doc);
+
+  XmlRelaxNGCompiledPtr compiled;
+};
+
+// A compiled Schematron schema, keeping the copy of the schema document its
+// assert / report messages are read from
+struct XmlSchematronCompiled {
+  XmlSchematronCompiled(xmlSchematron *schema, xmlDoc *doc);
+  ~XmlSchematronCompiled();
+
+  xmlSchematron *schema;
+  xmlDoc *doc;
+};
+
+typedef std::shared_ptr<XmlSchematronCompiled> XmlSchematronCompiledPtr;
+
+class XmlSchematronSchema : public Napi::ObjectWrap<XmlSchematronSchema> {
+public:
+  explicit XmlSchematronSchema(const Napi::CallbackInfo &info);
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  // compile the Schematron schema held in doc, throws a JS exception and
+  // returns NULL on failure. See XmlSchema::Compile for copy_doc.
+  static XmlSchematronCompiledPtr Compile(Napi::Env env, xmlDoc *doc,
+                                          bool copy_doc);
+
+  XmlSchematronCompiledPtr compiled;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_SCHEMA_H_
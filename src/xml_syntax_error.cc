@@ -17,15 +17,45 @@ void set_string_field(Napi::Env env, Napi::Object obj, const char *name,
   obj.Set(name, Napi::String::New(env, value, strlen(value)));
 }
 
+void set_string_field(Napi::Env env, Napi::Object obj, const char *name,
+                      const std::optional<std::string> &value) {
+  if (!value) {
+    return;
+  }
+  obj.Set(name, Napi::String::New(env, *value));
+}
+
 void set_numeric_field(Napi::Env env, Napi::Object obj, const char *name,
                        const int value) {
   obj.Set(name, Napi::Number::New(env, value));
 }
 
+std::optional<std::string> copy_string(const char *value) {
+  if (!value) {
+    return std::nullopt;
+  }
+  return std::string(value);
+}
+
 } // anonymous namespace
 
 namespace libxmljs {
 
+XmlErrorRecord::XmlErrorRecord(const xmlError *error)
+    : domain(error->domain), code(error->code), level(error->level),
+      line(error->line), column(error->int2), int1(error->int1),
+      message(copy_string(error->message)), file(copy_string(error->file)),
+      str1(copy_string(error->str1)), str2(copy_string(error->str2)),
+      str3(copy_string(error->str3)) {
+  if (error->node) {
+    xmlChar *nodePath = xmlGetNodePath(static_cast<xmlNode *>(error->node));
+    if (nodePath) {
+      xpath = std::string(reinterpret_cast<const char *>(nodePath));
+      xmlFree(nodePath);
+    }
+  }
+}
+
 Napi::Error XmlSyntaxError::BuildSyntaxError(Napi::Env env,
                                              const xmlError *error) {
   Napi::Error err = Napi::Error::New(env, error->message);
@@ -59,6 +89,52 @@ Napi::Error XmlSyntaxError::BuildSyntaxError(Napi::Env env,
   return err;
 }
 
+Napi::Error XmlSyntaxError::BuildSyntaxError(Napi::Env env,
+                                             const XmlErrorRecord &record) {
+  Napi::Error err = Napi::Error::New(env, record.message.value_or(""));
+
+  set_numeric_field(env, err.Value(), "domain", record.domain);
+  set_numeric_field(env, err.Value(), "code", record.code);
+  set_string_field(env, err.Value(), "message", record.message);
+  set_numeric_field(env, err.Value(), "level", record.level);
+  set_numeric_field(env, err.Value(), "column", record.column);
+  set_string_field(env, err.Value(), "file", record.file);
+  set_numeric_field(env, err.Value(), "line", record.line);
+  set_string_field(env, err.Value(), "str1", record.str1);
+  set_string_field(env, err.Value(), "str2", record.str2);
+  set_string_field(env, err.Value(), "str3", record.str3);
+  set_string_field(env, err.Value(), "xpath", record.xpath);
+
+  // only add if we have something interesting
+  if (record.int1) {
+    set_numeric_field(env, err.Value(), "int1", record.int1);
+  }
+
+  return err;
+}
+
+Napi::Array
+XmlSyntaxError::BuildSyntaxErrors(Napi::Env env,
+                                  const std::vector<XmlErrorRecord> &records) {
+  Napi::Array errors = Napi::Array::New(env, records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    errors.Set(static_cast<uint32_t>(i),
+               BuildSyntaxError(env, records[i]).Value());
+  }
+  return errors;
+}
+
+void XmlSyntaxError::PushToRecords(void *records, const xmlError *error) {
+  static_cast<std::vector<XmlErrorRecord> *>(records)->emplace_back(error);
+}
+
+void XmlSyntaxError::PushToCollector(void *collector, const xmlError *error) {
+  XmlErrorCollector *errors = static_cast<XmlErrorCollector *>(collector);
+  if (errors->records.size() < errors->max_errors) {
+    errors->records.emplace_back(error);
+  }
+}
+
 void XmlSyntaxError::PushToArray(void *errs, const xmlError *error) {
   ErrorArrayContext *ctx = static_cast<ErrorArrayContext *>(errs);
   Napi::Env env = ctx->env;
@@ -2,6 +2,12 @@
 #ifndef SRC_XML_SYNTAX_ERROR_H_
 #define SRC_XML_SYNTAX_ERROR_H_
 
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include <libxml/xmlerror.h>
 
 #include "libxmljs.h"
@@ -13,6 +19,36 @@ struct ErrorArrayContext {
   Napi::Array errors;
 };
 
+// Plain copy of an xmlError that does not touch the JS heap, so it can be
+// collected off the main thread and turned into a JS error later on
+struct XmlErrorRecord {
+  explicit XmlErrorRecord(const xmlError *error);
+
+  int domain;
+  int code;
+  int level;
+  int line;
+  int column;
+  int int1;
+  std::optional<std::string> message;
+  std::optional<std::string> file;
+  std::optional<std::string> str1;
+  std::optional<std::string> str2;
+  std::optional<std::string> str3;
+  std::optional<std::string> xpath;
+};
+
+// Collects error records up to a limit, any further errors are dropped
+// without being copied
+struct XmlErrorCollector {
+  explicit XmlErrorCollector(
+      size_t max_errors = std::numeric_limits<size_t>::max())
+      : max_errors(max_errors) {}
+
+  std::vector<XmlErrorRecord> records;
+  size_t max_errors;
+};
+
 // Utility class for creating syntax error objects
 // Not an ObjectWrap - just a namespace-like utility class
 class XmlSyntaxError {
@@ -21,9 +57,22 @@ public:
   // helper method for xml library
   static void PushToArray(void *errs, const xmlError *error);
 
+  // push xmlError onto a std::vector<XmlErrorRecord>
+  // safe to use from any thread
+  static void PushToRecords(void *records, const xmlError *error);
+
+  // push xmlError onto an XmlErrorCollector, safe to use from any thread
+  static void PushToCollector(void *collector, const xmlError *error);
+
   // create a Napi::Value object for the syntax error
   // TODO make it a proper Error object
   static Napi::Error BuildSyntaxError(Napi::Env env, const xmlError *error);
+  static Napi::Error BuildSyntaxError(Napi::Env env,
+                                      const XmlErrorRecord &record);
+
+  // convert collected records into a JS array of syntax errors
+  static Napi::Array
+  BuildSyntaxErrors(Napi::Env env, const std::vector<XmlErrorRecord> &records);
 };
 
 } // namespace libxmljs
@@ -31,44 +31,32 @@ XmlText::XmlText(const Napi::CallbackInfo &info) : XmlNode<XmlText>(info) {
 
   // if we were created for an existing xml node, then we don't need
   // to create a new node on the document
-  xmlNode *textNode;
-
-  if (info.Length() == 1 && info[0].IsExternal()) {
-    // Unwrap the external to get the xmlNode pointer
-    textNode = info[0].As<Napi::External<xmlNode>>().Data();
-  } else {
-    DOCUMENT_ARG_CHECK;
-
-    if (!info[1].IsString()) {
-      Napi::TypeError::New(env, "content argument must be of type string")
-          .ThrowAsJavaScriptException();
-      return;
-    }
-
-    Napi::Object docObj = info[0].ToObject();
-    XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(docObj);
-    if (document == nullptr) {
-      Napi::Error::New(env, "Invalid document argument")
-          .ThrowAsJavaScriptException();
-      return;
-    }
+  if (this->xml_obj != NULL) {
+    this->wrap_xml_obj();
+    return;
+  }
 
-    std::string content = info[1].ToString().Utf8Value();
+  DOCUMENT_ARG_CHECK;
 
-    textNode =
-        xmlNewDocText(document->xml_obj, (const xmlChar *)content.c_str());
+  if (!info[1].IsString()) {
+    Napi::TypeError::New(env, "content argument must be of type string")
+        .ThrowAsJavaScriptException();
+    return;
   }
 
-  this->xml_obj = textNode;
-  this->xml_obj->_private = this;
-  this->ancestor = NULL;
-
-  if ((this->xml_obj->doc != NULL) && (this->xml_obj->doc->_private != NULL)) {
-    XmlDocument *doc = static_cast<XmlDocument *>(this->xml_obj->doc->_private);
-    this->Value().Set("document", doc->Value());
+  Napi::Object docObj = info[0].ToObject();
+  XmlDocument *document = Napi::ObjectWrap<XmlDocument>::Unwrap(docObj);
+  if (document == nullptr) {
+    Napi::Error::New(env, "Invalid document argument")
+        .ThrowAsJavaScriptException();
+    return;
   }
 
-  this->ref_wrapped_ancestor();
+  std::string content = info[1].ToString().Utf8Value();
+
+  this->xml_obj =
+      xmlNewDocText(document->xml_obj, (const xmlChar *)content.c_str());
+  this->wrap_xml_obj();
 }
 
 Napi::Value XmlText::NewInstance(Napi::Env env, xmlNode *node) {
@@ -81,8 +69,7 @@ Napi::Value XmlText::NewInstance(Napi::Env env, xmlNode *node) {
     }
   }
 
-  auto external = Napi::External<xmlNode>::New(env, node);
-  Napi::Object instance = constructor.New({external});
+  Napi::Object instance = XmlText::NewWrapper(node);
   return scope.Escape(instance);
 }
 
@@ -271,21 +258,32 @@ Napi::Value XmlText::get_prev_element(Napi::Env env) {
   return scope.Escape(env.Null());
 }
 
+// a text node merged into this one is freed and so was never linked
+
 void XmlText::add_prev_sibling(xmlNode *element) {
-  xmlAddPrevSibling(xml_obj, element);
+  if (xmlAddPrevSibling(xml_obj, element) == element) {
+    XmlDetachedTrees::linked(element);
+  }
 }
 
 void XmlText::add_next_sibling(xmlNode *element) {
-  xmlAddNextSibling(xml_obj, element);
+  if (xmlAddNextSibling(xml_obj, element) == element) {
+    XmlDetachedTrees::linked(element);
+  }
 }
 
 void XmlText::replace_element(xmlNode *element) {
+  xmlNode *parent = xml_obj->parent;
   xmlReplaceNode(xml_obj, element);
+  XmlDetachedTrees::linked(element);
+  XmlDetachedTrees::unlinked(xml_obj, parent);
 }
 
 void XmlText::replace_text(const char *content) {
   xmlNodePtr txt = xmlNewDocText(xml_obj->doc, (const xmlChar *)content);
+  xmlNode *parent = xml_obj->parent;
   xmlReplaceNode(xml_obj, txt);
+  XmlDetachedTrees::unlinked(xml_obj, parent);
 }
 
 bool XmlText::next_sibling_will_merge(xmlNode *child) {
@@ -320,6 +318,7 @@ Napi::Function XmlText::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod("toString", &XmlNode::ToString),
           InstanceMethod("remove", &XmlNode::Remove),
           InstanceMethod("clone", &XmlNode::Clone),
+          InstanceAccessor("document", &XmlNode::GetDocument, nullptr),
       });
 
   constructor = Napi::Persistent(func);
@@ -0,0 +1,391 @@
+// Copyright 2009, Squish Tech, LLC.
+
+#include "xml_text_reader.h"
+#include "xml_document.h"
+#include "xml_element.h"
+
+namespace libxmljs {
+
+static Napi::Value StringOrNull(Napi::Env env, const xmlChar *str) {
+  if (str == NULL) {
+    return env.Null();
+  }
+  return Napi::String::New(env, (const char *)str);
+}
+
+Napi::FunctionReference XmlTextReader::constructor;
+
+// JS-signature: (input: string | Buffer, options?: object, file?: boolean)
+XmlTextReader::XmlTextReader(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlTextReader>(info), reader(NULL) {
+  Napi::Env env = info.Env();
+
+  bool file = info.Length() > 2 && info[2].ToBoolean().Value();
+  if (file && (info.Length() == 0 || !info[0].IsString())) {
+    Napi::TypeError::New(env, "TextReader.fromFile requires a file name")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  if (info.Length() == 0 || !(info[0].IsString() || info[0].IsBuffer())) {
+    Napi::TypeError::New(env, "TextReader requires a string or Buffer")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object options =
+      info.Length() > 1 && info[1].IsObject() ? info[1].ToObject()
+                                              : Napi::Object::New(env);
+  XmlParseOptions parse_options = XmlParseOptions::Read(options);
+
+  // the file is read in chunks as the reader moves on
+  if (file) {
+    std::string filename = info[0].As<Napi::String>().Utf8Value();
+    reader = xmlReaderForFile(filename.c_str(),
+                              parse_options.encoding_or_null(),
+                              parse_options.opts);
+    if (reader == NULL) {
+      Napi::Error::New(env, "Could not open " + filename)
+          .ThrowAsJavaScriptException();
+      return;
+    }
+
+    xmlTextReaderSetStructuredErrorHandler(
+        reader, XmlSyntaxError::PushToRecords, &errors);
+    return;
+  }
+
+  const char *data;
+  size_t length;
+  if (info[0].IsBuffer()) {
+    Napi::Buffer<char> buf = info[0].As<Napi::Buffer<char>>();
+    buffer_ref = Napi::Persistent(buf);
+    data = buf.Data();
+    length = buf.Length();
+  } else {
+    str = info[0].As<Napi::String>().Utf8Value();
+    data = str.c_str();
+    length = str.length();
+  }
+
+  reader = xmlReaderForMemory(data, length, parse_options.base_url_or_null(),
+                              parse_options.encoding_or_null(),
+                              parse_options.opts);
+  if (reader == NULL) {
+    Napi::Error::New(env, "Could not create text reader")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  xmlTextReaderSetStructuredErrorHandler(reader, XmlSyntaxError::PushToRecords,
+                                         &errors);
+}
+
+// JS-signature: (filename: string, options?: object)
+Napi::Value XmlTextReader::FromFile(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  return constructor.New({info.Length() > 0 ? info[0] : env.Undefined(),
+                          info.Length() > 1 ? info[1] : env.Undefined(),
+                          Napi::Boolean::New(env, true)});
+}
+
+XmlTextReader::~XmlTextReader() { close(); }
+
+void XmlTextReader::close() {
+  if (reader != NULL) {
+    xmlFreeTextReader(reader);
+    reader = NULL;
+  }
+  str.clear();
+  buffer_ref.Reset();
+}
+
+bool XmlTextReader::check_open(Napi::Env env) {
+  if (reader == NULL) {
+    Napi::Error::New(env, "TextReader is closed").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
+
+Napi::Value XmlTextReader::read_result(Napi::Env env, int result) {
+  if (result >= 0) {
+    return Napi::Boolean::New(env, result == 1);
+  }
+
+  if (!errors.empty()) {
+    XmlSyntaxError::BuildSyntaxError(env, errors.back())
+        .ThrowAsJavaScriptException();
+  } else {
+    Napi::Error::New(env, "Could not read XML").ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+Napi::Value XmlTextReader::Read(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return read_result(env, xmlTextReaderRead(reader));
+}
+
+// skip the subtree of the current node
+Napi::Value XmlTextReader::Next(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return read_result(env, xmlTextReaderNext(reader));
+}
+
+Napi::Value XmlTextReader::NodeType(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return Napi::Number::New(env, xmlTextReaderNodeType(reader));
+}
+
+Napi::Value XmlTextReader::Name(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return StringOrNull(env, xmlTextReaderConstName(reader));
+}
+
+Napi::Value XmlTextReader::LocalName(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return StringOrNull(env, xmlTextReaderConstLocalName(reader));
+}
+
+Napi::Value XmlTextReader::Prefix(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return StringOrNull(env, xmlTextReaderConstPrefix(reader));
+}
+
+Napi::Value XmlTextReader::NamespaceUri(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return StringOrNull(env, xmlTextReaderConstNamespaceUri(reader));
+}
+
+Napi::Value XmlTextReader::Value(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return StringOrNull(env, xmlTextReaderConstValue(reader));
+}
+
+Napi::Value XmlTextReader::Depth(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return Napi::Number::New(env, xmlTextReaderDepth(reader));
+}
+
+Napi::Value XmlTextReader::IsEmptyElement(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return Napi::Boolean::New(env, xmlTextReaderIsEmptyElement(reader) == 1);
+}
+
+Napi::Value XmlTextReader::HasValue(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return Napi::Boolean::New(env, xmlTextReaderHasValue(reader) == 1);
+}
+
+Napi::Value XmlTextReader::AttributeCount(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return Napi::Number::New(env, xmlTextReaderAttributeCount(reader));
+}
+
+// JS-signature: (name: string)
+Napi::Value XmlTextReader::GetAttribute(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+
+  std::string name = info[0].ToString().Utf8Value();
+  xmlChar *value =
+      xmlTextReaderGetAttribute(reader, (const xmlChar *)name.c_str());
+  if (value == NULL) {
+    return env.Null();
+  }
+
+  Napi::String ret = Napi::String::New(env, (const char *)value);
+  xmlFree(value);
+  return ret;
+}
+
+// all attributes of the current element as a plain name -> value object
+Napi::Value XmlTextReader::Attributes(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+
+  Napi::Object attrs = Napi::Object::New(env);
+  if (xmlTextReaderMoveToFirstAttribute(reader) != 1) {
+    return attrs;
+  }
+
+  do {
+    // namespace declarations are reported as attributes too, skip them
+    if (xmlTextReaderIsNamespaceDecl(reader) == 1) {
+      continue;
+    }
+    attrs.Set((const char *)xmlTextReaderConstName(reader),
+              StringOrNull(env, xmlTextReaderConstValue(reader)));
+  } while (xmlTextReaderMoveToNextAttribute(reader) == 1);
+
+  xmlTextReaderMoveToElement(reader);
+  return attrs;
+}
+
+Napi::Value
+XmlTextReader::MoveToFirstAttribute(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return read_result(env, xmlTextReaderMoveToFirstAttribute(reader));
+}
+
+Napi::Value XmlTextReader::MoveToNextAttribute(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return read_result(env, xmlTextReaderMoveToNextAttribute(reader));
+}
+
+Napi::Value XmlTextReader::MoveToElement(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (!check_open(env)) {
+    return env.Undefined();
+  }
+  return read_result(env, xmlTextReaderMoveToElement(reader));
+}
+
+// The expanded nodes belong to the reader and are freed once it moves on,
+// so the subtree is copied into a document of its own. Returns the root
+// element of that document, or null if the current node is no element.
+Napi::Value XmlTextReader::Expand(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  Napi::EscapableHandleScope scope(env);
+  if (!check_open(env)) {
+    return scope.Escape(env.Undefined());
+  }
+
+  xmlNode *node = xmlTextReaderExpand(reader);
+  if (node == NULL) {
+    return scope.Escape(read_result(env, -1));
+  }
+  if (node->type != XML_ELEMENT_NODE) {
+    return scope.Escape(env.Null());
+  }
+
+  xmlDoc *doc = xmlNewDoc((const xmlChar *)"1.0");
+  xmlNode *copy = xmlDocCopyNode(node, doc, 1);
+  if (copy == NULL) {
+    xmlFreeDoc(doc);
+    Napi::Error::New(env, "Could not copy expanded node")
+        .ThrowAsJavaScriptException();
+    return scope.Escape(env.Undefined());
+  }
+  xmlDocSetRootElement(doc, copy);
+
+  // wrapping the document first lets it own the copied tree
+  XmlDocument::NewInstance(env, doc);
+  return scope.Escape(XmlElement::NewInstance(env, copy));
+}
+
+// recoverable errors and warnings seen so far
+Napi::Value XmlTextReader::Errors(const Napi::CallbackInfo &info) {
+  return XmlSyntaxError::BuildSyntaxErrors(info.Env(), errors);
+}
+
+Napi::Value XmlTextReader::Close(const Napi::CallbackInfo &info) {
+  close();
+  return info.Env().Undefined();
+}
+
+void XmlTextReader::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "TextReader",
+      {
+          InstanceMethod("read", &XmlTextReader::Read),
+          InstanceMethod("next", &XmlTextReader::Next),
+          InstanceMethod("nodeType", &XmlTextReader::NodeType),
+          InstanceMethod("name", &XmlTextReader::Name),
+          InstanceMethod("localName", &XmlTextReader::LocalName),
+          InstanceMethod("prefix", &XmlTextReader::Prefix),
+          InstanceMethod("namespaceUri", &XmlTextReader::NamespaceUri),
+          InstanceMethod("value", &XmlTextReader::Value),
+          InstanceMethod("depth", &XmlTextReader::Depth),
+          InstanceMethod("isEmptyElement", &XmlTextReader::IsEmptyElement),
+          InstanceMethod("hasValue", &XmlTextReader::HasValue),
+          InstanceMethod("attributeCount", &XmlTextReader::AttributeCount),
+          InstanceMethod("getAttribute", &XmlTextReader::GetAttribute),
+          InstanceMethod("attributes", &XmlTextReader::Attributes),
+          InstanceMethod("moveToFirstAttribute",
+                         &XmlTextReader::MoveToFirstAttribute),
+          InstanceMethod("moveToNextAttribute",
+                         &XmlTextReader::MoveToNextAttribute),
+          InstanceMethod("moveToElement", &XmlTextReader::MoveToElement),
+          InstanceMethod("expand", &XmlTextReader::Expand),
+          InstanceMethod("errors", &XmlTextReader::Errors),
+          InstanceMethod("close", &XmlTextReader::Close),
+          StaticMethod("fromFile", &XmlTextReader::FromFile),
+
+          // node types as returned by nodeType()
+          StaticValue("ELEMENT", Napi::Number::New(
+                                     env, XML_READER_TYPE_ELEMENT)),
+          StaticValue("ATTRIBUTE", Napi::Number::New(
+                                       env, XML_READER_TYPE_ATTRIBUTE)),
+          StaticValue("TEXT", Napi::Number::New(env, XML_READER_TYPE_TEXT)),
+          StaticValue("CDATA", Napi::Number::New(env, XML_READER_TYPE_CDATA)),
+          StaticValue("PROCESSING_INSTRUCTION",
+                      Napi::Number::New(
+                          env, XML_READER_TYPE_PROCESSING_INSTRUCTION)),
+          StaticValue("COMMENT", Napi::Number::New(
+                                     env, XML_READER_TYPE_COMMENT)),
+          StaticValue("DOCUMENT_TYPE", Napi::Number::New(
+                                           env, XML_READER_TYPE_DOCUMENT_TYPE)),
+          StaticValue("WHITESPACE", Napi::Number::New(
+                                        env, XML_READER_TYPE_WHITESPACE)),
+          StaticValue("SIGNIFICANT_WHITESPACE",
+                      Napi::Number::New(
+                          env, XML_READER_TYPE_SIGNIFICANT_WHITESPACE)),
+          StaticValue("END_ELEMENT", Napi::Number::New(
+                                         env, XML_READER_TYPE_END_ELEMENT)),
+      });
+
+  constructor = Napi::Persistent(func);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("TextReader", func);
+}
+
+} // namespace libxmljs
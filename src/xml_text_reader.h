@@ -0,0 +1,71 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_TEXT_READER_H_
+#define SRC_XML_TEXT_READER_H_
+
+#include <string>
+#include <vector>
+
+#include <libxml/xmlreader.h>
+
+#include "libxmljs.h"
+#include "xml_syntax_error.h"
+
+namespace libxmljs {
+
+// Pull parser over xmlTextReader. Only the current node of the tree is kept,
+// nodes the reader moved past are freed again by libxml. A file is read in
+// chunks as the reader moves on; a string or Buffer input stays resident in
+// whole (a string as a UTF-8 copy) until the reader is closed.
+class XmlTextReader : public Napi::ObjectWrap<XmlTextReader> {
+public:
+  explicit XmlTextReader(const Napi::CallbackInfo &info);
+  ~XmlTextReader();
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  // reader over a file, which libxml reads as it goes
+  static Napi::Value FromFile(const Napi::CallbackInfo &info);
+
+private:
+  Napi::Value Read(const Napi::CallbackInfo &info);
+  Napi::Value Next(const Napi::CallbackInfo &info);
+  Napi::Value NodeType(const Napi::CallbackInfo &info);
+  Napi::Value Name(const Napi::CallbackInfo &info);
+  Napi::Value LocalName(const Napi::CallbackInfo &info);
+  Napi::Value Prefix(const Napi::CallbackInfo &info);
+  Napi::Value NamespaceUri(const Napi::CallbackInfo &info);
+  Napi::Value Value(const Napi::CallbackInfo &info);
+  Napi::Value Depth(const Napi::CallbackInfo &info);
+  Napi::Value IsEmptyElement(const Napi::CallbackInfo &info);
+  Napi::Value HasValue(const Napi::CallbackInfo &info);
+  Napi::Value AttributeCount(const Napi::CallbackInfo &info);
+  Napi::Value GetAttribute(const Napi::CallbackInfo &info);
+  Napi::Value Attributes(const Napi::CallbackInfo &info);
+  Napi::Value MoveToFirstAttribute(const Napi::CallbackInfo &info);
+  Napi::Value MoveToNextAttribute(const Napi::CallbackInfo &info);
+  Napi::Value MoveToElement(const Napi::CallbackInfo &info);
+  Napi::Value Expand(const Napi::CallbackInfo &info);
+  Napi::Value Errors(const Napi::CallbackInfo &info);
+  Napi::Value Close(const Napi::CallbackInfo &info);
+
+  // turn a read / next result into a JS value, throws on -1
+  Napi::Value read_result(Napi::Env env, int result);
+
+  // throws if the reader was closed already
+  bool check_open(Napi::Env env);
+
+  void close();
+
+  xmlTextReaderPtr reader;
+
+  // the reader parses straight from this memory, it has to stay around
+  std::string str;
+  Napi::Reference<Napi::Buffer<char>> buffer_ref;
+
+  std::vector<XmlErrorRecord> errors;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_TEXT_READER_H_
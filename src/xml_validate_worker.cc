@@ -0,0 +1,48 @@
+// Copyright 2009, Squish Tech, LLC.
+
+#include <libxml/xmlschemas.h>
+
+#include "xml_validate_worker.h"
+
+namespace libxmljs {
+
+XmlValidateWorker::XmlValidateWorker(Napi::Env env, Napi::Object document,
+                                     xmlDoc *doc,
+                                     XmlSchemaCompiledPtr compiled)
+    : Napi::AsyncWorker(env), deferred(Napi::Promise::Deferred::New(env)),
+      document_ref(Napi::Persistent(document)), doc(doc), compiled(compiled),
+      valid(false) {}
+
+XmlValidateWorker::~XmlValidateWorker() { xmlFreeDoc(doc); }
+
+// runs on the threadpool: must not touch any napi value
+void XmlValidateWorker::Execute() {
+  xmlSchemaValidCtxtPtr valid_ctxt = xmlSchemaNewValidCtxt(compiled->schema);
+  if (valid_ctxt == NULL) {
+    SetError("Unable to create a validation context for the schema");
+    return;
+  }
+
+  xmlSchemaSetValidStructuredErrors(valid_ctxt, XmlSyntaxError::PushToRecords,
+                                    &errors);
+
+  valid = xmlSchemaValidateDoc(valid_ctxt, doc) == 0;
+
+  xmlSchemaFreeValidCtxt(valid_ctxt);
+}
+
+void XmlValidateWorker::OnOK() {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  document_ref.Value().Set("validationErrors",
+                           XmlSyntaxError::BuildSyntaxErrors(env, errors));
+  deferred.Resolve(Napi::Boolean::New(env, valid));
+}
+
+void XmlValidateWorker::OnError(const Napi::Error &error) {
+  Napi::HandleScope scope(Env());
+  deferred.Reject(error.Value());
+}
+
+} // namespace libxmljs
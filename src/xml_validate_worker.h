@@ -0,0 +1,48 @@
+// Copyright 2009, Squish Tech, LLC.
+#ifndef SRC_XML_VALIDATE_WORKER_H_
+#define SRC_XML_VALIDATE_WORKER_H_
+
+#include <string>
+#include <vector>
+
+#include <libxml/tree.h>
+
+#include "libxmljs.h"
+#include "xml_schema.h"
+#include "xml_syntax_error.h"
+
+namespace libxmljs {
+
+// Validates a document against a compiled XSD on the libuv threadpool.
+// Errors are collected as plain records and only turned into JS objects
+// once the validation is done. Validation writes to the document it checks
+// (ID table, attribute types, dictionary), so the worker owns a copy of the
+// document and the original stays free to use meanwhile.
+class XmlValidateWorker : public Napi::AsyncWorker {
+public:
+  XmlValidateWorker(Napi::Env env, Napi::Object document, xmlDoc *doc,
+                    XmlSchemaCompiledPtr compiled);
+  ~XmlValidateWorker();
+
+  Napi::Promise Promise() { return deferred.Promise(); }
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &error) override;
+
+private:
+  Napi::Promise::Deferred deferred;
+
+  // the document the result is reported on, and the copy that is validated
+  Napi::ObjectReference document_ref;
+  xmlDoc *doc;
+  XmlSchemaCompiledPtr compiled;
+
+  bool valid;
+  std::vector<XmlErrorRecord> errors;
+};
+
+} // namespace libxmljs
+
+#endif // SRC_XML_VALIDATE_WORKER_H_
@@ -12,10 +12,56 @@
 
 #include "xml_element.h"
 #include "xml_node.h"
+#include "xml_syntax_error.h"
 #include "xml_xpath_context.h"
 
 namespace libxmljs {
 
+// default number of compiled expressions kept by the cache
+const size_t XPATH_CACHE_DEFAULT_CAPACITY = 256;
+
+XmlXPathCache::XmlXPathCache()
+    : capacity(XPATH_CACHE_DEFAULT_CAPACITY), hits(0), misses(0) {}
+
+XmlXPathCache &XmlXPathCache::current() {
+  static thread_local XmlXPathCache cache;
+  return cache;
+}
+
+XmlXPathCompiledPtr XmlXPathCache::get(const std::string &xpath) {
+  auto found = index.find(xpath);
+  if (found != index.end()) {
+    hits++;
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->second;
+  }
+
+  misses++;
+  xmlXPathCompExpr *comp = xmlXPathCompile((const xmlChar *)xpath.c_str());
+  if (comp == NULL) {
+    return nullptr;
+  }
+
+  XmlXPathCompiledPtr compiled = std::make_shared<XmlXPathCompiled>(comp);
+  if (capacity == 0) {
+    return compiled;
+  }
+
+  entries.emplace_front(xpath, compiled);
+  index[xpath] = entries.begin();
+  set_capacity(capacity);
+
+  return compiled;
+}
+
+void XmlXPathCache::set_capacity(size_t new_capacity) {
+  capacity = new_capacity;
+  while (entries.size() > capacity) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+}
+
 XmlXpathContext::XmlXpathContext(xmlNode *node) {
   ctxt = xmlXPathNewContext(node->doc);
   ctxt->node = node;
@@ -29,7 +75,28 @@ void XmlXpathContext::register_ns(const xmlChar *prefix, const xmlChar *uri) {
 
 Napi::Value XmlXpathContext::evaluate(Napi::Env env, const xmlChar *xpath) {
   Napi::EscapableHandleScope scope(env);
-  xmlXPathObject *xpathobj = xmlXPathEval(xpath, ctxt);
+  XmlXPathCompiledPtr compiled =
+      XmlXPathCache::current().get((const char *)xpath);
+
+  if (!compiled) {
+    return scope.Escape(env.Null());
+  }
+
+  return scope.Escape(this->evaluate(env, compiled->comp));
+}
+
+Napi::Value XmlXpathContext::evaluate(Napi::Env env, xmlXPathCompExpr *comp) {
+  Napi::EscapableHandleScope scope(env);
+  xmlXPathObject *xpathobj = xmlXPathCompiledEval(comp, ctxt);
+  Napi::Value res = this->to_value(env, xpathobj);
+
+  xmlXPathFreeObject(xpathobj);
+  return scope.Escape(res);
+}
+
+Napi::Value XmlXpathContext::to_value(Napi::Env env,
+                                      xmlXPathObject *xpathobj) {
+  Napi::EscapableHandleScope scope(env);
   Napi::Value res;
 
   if (xpathobj) {
@@ -73,8 +140,89 @@ Napi::Value XmlXpathContext::evaluate(Napi::Env env, const xmlChar *xpath) {
     res = env.Null();
   }
 
-  xmlXPathFreeObject(xpathobj);
   return scope.Escape(res);
 }
 
+Napi::FunctionReference XmlXPathExpression::constructor;
+
+// JS-signature: (expression: string)
+XmlXPathExpression::XmlXPathExpression(const Napi::CallbackInfo &info)
+    : Napi::ObjectWrap<XmlXPathExpression>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "XPath expression must be a string")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  expression = info[0].As<Napi::String>().Utf8Value();
+
+  xmlResetLastError();
+  xmlXPathCompExpr *comp = xmlXPathCompile((const xmlChar *)expression.c_str());
+  if (comp == NULL) {
+    const xmlError *error = xmlGetLastError();
+    if (error) {
+      XmlSyntaxError::BuildSyntaxError(env, error).ThrowAsJavaScriptException();
+      return;
+    }
+    Napi::Error::New(env, "Invalid XPath expression")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  compiled = std::make_shared<XmlXPathCompiled>(comp);
+}
+
+Napi::Value XmlXPathExpression::ToString(const Napi::CallbackInfo &info) {
+  return Napi::String::New(info.Env(), expression);
+}
+
+Napi::Value XmlXPathExpression::CacheStats(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  XmlXPathCache &cache = XmlXPathCache::current();
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("hits", Napi::Number::New(env, cache.hits));
+  stats.Set("misses", Napi::Number::New(env, cache.misses));
+  stats.Set("size", Napi::Number::New(env, cache.size()));
+  stats.Set("capacity", Napi::Number::New(env, cache.capacity));
+
+  return stats;
+}
+
+Napi::Value XmlXPathExpression::SetCacheSize(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber() ||
+      info[0].As<Napi::Number>().Int64Value() < 0) {
+    Napi::TypeError::New(env, "cache size must be a non-negative number")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  XmlXPathCache::current().set_capacity(
+      static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+
+  return env.Undefined();
+}
+
+void XmlXPathExpression::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function ctor =
+      DefineClass(env, "XPath",
+                  {
+                      InstanceMethod("toString", &XmlXPathExpression::ToString),
+                  });
+
+  constructor = Napi::Persistent(ctor);
+  constructor.SuppressDestruct();
+  env.AddCleanupHook([]() { constructor.Reset(); });
+
+  exports.Set("XPath", ctor);
+  exports.Set("xpathCacheStats",
+              Napi::Function::New(env, XmlXPathExpression::CacheStats));
+  exports.Set("setXPathCacheSize",
+              Napi::Function::New(env, XmlXPathExpression::SetCacheSize));
+}
+
 } // namespace libxmljs
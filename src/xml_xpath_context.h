@@ -2,6 +2,12 @@
 #ifndef SRC_XML_XPATH_CONTEXT_H_
 #define SRC_XML_XPATH_CONTEXT_H_
 
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
 #include <libxml/xpath.h>
 
 #include "libxmljs.h"
@@ -9,6 +15,46 @@
 
 namespace libxmljs {
 
+// Owns a compiled XPath expression, shared between the cache and JS handles
+class XmlXPathCompiled {
+public:
+  explicit XmlXPathCompiled(xmlXPathCompExpr *comp) : comp(comp) {}
+  ~XmlXPathCompiled() { xmlXPathFreeCompExpr(comp); }
+
+  XmlXPathCompiled(const XmlXPathCompiled &) = delete;
+  XmlXPathCompiled &operator=(const XmlXPathCompiled &) = delete;
+
+  xmlXPathCompExpr *comp;
+};
+
+typedef std::shared_ptr<XmlXPathCompiled> XmlXPathCompiledPtr;
+
+// LRU cache of compiled expressions keyed by expression text, so that
+// repeated find/get calls skip parsing the expression. One per JS thread.
+class XmlXPathCache {
+public:
+  static XmlXPathCache &current();
+
+  // compiled expression for xpath, or NULL if it does not compile
+  XmlXPathCompiledPtr get(const std::string &xpath);
+
+  void set_capacity(size_t capacity);
+
+  size_t capacity;
+  size_t hits;
+  size_t misses;
+  size_t size() const { return entries.size(); }
+
+private:
+  XmlXPathCache();
+
+  typedef std::list<std::pair<std::string, XmlXPathCompiledPtr>> EntryList;
+
+  // most recently used first
+  EntryList entries;
+  std::unordered_map<std::string, EntryList::iterator> index;
+};
+
 // Utility class for XPath context operations
 // Not an ObjectWrap - just a utility class
 class XmlXpathContext {
@@ -18,8 +64,32 @@ public:
 
   void register_ns(const xmlChar *prefix, const xmlChar *uri);
   Napi::Value evaluate(Napi::Env env, const xmlChar *xpath);
+  Napi::Value evaluate(Napi::Env env, xmlXPathCompExpr *comp);
 
   xmlXPathContext *ctxt;
+
+private:
+  Napi::Value to_value(Napi::Env env, xmlXPathObject *xpathobj);
+};
+
+// JS handle for an XPath expression compiled once and reused with
+// Element#find / Element#get
+class XmlXPathExpression : public Napi::ObjectWrap<XmlXPathExpression> {
+public:
+  explicit XmlXPathExpression(const Napi::CallbackInfo &info);
+
+  static void Init(Napi::Env env, Napi::Object exports);
+  static Napi::FunctionReference constructor;
+
+  XmlXPathCompiledPtr compiled;
+
+protected:
+  Napi::Value ToString(const Napi::CallbackInfo &info);
+
+  static Napi::Value CacheStats(const Napi::CallbackInfo &info);
+  static Napi::Value SetCacheSize(const Napi::CallbackInfo &info);
+
+  std::string expression;
 };
 
 } // namespace libxmljs
@@ -0,0 +1,126 @@
+import * as libxml from "../index.js";
+import { setupGC } from "./setup.js";
+
+describe('cursor', () => {
+  const xml =
+    '<root>' +
+    '<item id="1">first</item>' +
+    '<item id="2"><![CDATA[second]]><b>!</b></item>' +
+    '<!-- note -->' +
+    '<empty/>' +
+    '</root>';
+
+  it('walk', () => {
+    const doc = libxml.parseXml(xml);
+    const cursor = new libxml.Cursor(doc);
+    const events = [];
+
+    // depth first over the whole tree
+    let more = true;
+    while (more) {
+      events.push([cursor.type(), cursor.name(), cursor.depth()]);
+      if (cursor.firstChild()) {
+        continue;
+      }
+      while (!cursor.next()) {
+        if (!cursor.parent()) {
+          more = false;
+          break;
+        }
+      }
+    }
+
+    expect(events).toEqual([
+      ['element', 'root', 0],
+      ['element', 'item', 1],
+      ['text', 'text', 2],
+      ['element', 'item', 1],
+      ['cdata', null, 2],
+      ['element', 'b', 2],
+      ['text', 'text', 3],
+      ['comment', 'comment', 1],
+      ['element', 'empty', 1],
+    ]);
+  });
+
+  it('values', () => {
+    const doc = libxml.parseXml(xml);
+    const cursor = new libxml.Cursor(doc);
+
+    expect(cursor.text()).toBe('firstsecond!');
+    expect(cursor.attr('id')).toBe(null);
+
+    cursor.firstChild();
+    expect(cursor.attr('id')).toBe('1');
+    expect(cursor.text()).toBe('first');
+
+    cursor.next();
+    expect(cursor.attr('id')).toBe('2');
+    expect(cursor.text()).toBe('second!');
+    expect(cursor.attr('missing')).toBe(null);
+
+    cursor.next();
+    expect(cursor.type()).toBe('comment');
+    expect(cursor.text()).toBe(' note ');
+    expect(cursor.attr('id')).toBe(null);
+
+    cursor.reset();
+    expect(cursor.name()).toBe('root');
+    expect(cursor.depth()).toBe(0);
+
+    expect(() => cursor.attr(1)).toThrow(
+      'Bad Argument: attribute name must be a string'
+    );
+  });
+
+  it('stays within its subtree', () => {
+    const doc = libxml.parseXml(xml);
+    const cursor = new libxml.Cursor(doc.get('//item[2]'));
+
+    expect(cursor.next()).toBe(false);
+    expect(cursor.parent()).toBe(false);
+    expect(cursor.name()).toBe('item');
+
+    expect(cursor.firstChild()).toBe(true);
+    expect(cursor.next()).toBe(true);
+    expect(cursor.name()).toBe('b');
+    expect(cursor.next()).toBe(false);
+    expect(cursor.parent()).toBe(true);
+    expect(cursor.parent()).toBe(false);
+  });
+
+  it('node freed under the cursor', async () => {
+    const { traceGC, awaitGC } = setupGC();
+    const doc = libxml.parseXml(xml);
+    const cursor = new libxml.Cursor(doc);
+
+    cursor.firstChild();
+    cursor.next();
+    cursor.firstChild();
+
+    // freed along with the last wrapper in the removed subtree
+    let item = doc.get('//item[2]');
+    item.remove();
+    traceGC(item, 'item');
+    item = null;
+
+    await awaitGC('item');
+    global.gc(true);
+    await new Promise(resolve => setTimeout(resolve, 1));
+
+    expect(() => cursor.name()).toThrow('the node under the cursor was freed');
+    cursor.reset();
+    expect(cursor.name()).toBe('root');
+    expect(cursor.firstChild() && cursor.next()).toBe(true);
+    expect(cursor.type()).toBe('comment');
+  });
+
+  it('arguments', () => {
+    expect(() => new libxml.Cursor({})).toThrow(
+      'Bad Argument: Cursor requires a Document or Element'
+    );
+    expect(() => new libxml.Cursor(new libxml.Document())).toThrow(
+      'document has no root element'
+    );
+  });
+});
@@ -255,6 +255,110 @@ describe('document', () => {
     expect(xmlDocInvalid.validationErrors.length).toBe(1);
   });
 
+  it('validate with compiled schema', () => {
+    const xsd =
+      '<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema"><xs:element name="comment" type="xs:string"/></xs:schema>';
+    let xsdDoc = libxml.parseXml(xsd);
+    const schema = new libxml.Schema(xsdDoc);
+
+    // the schema no longer depends on the document it was built from
+    xsdDoc.root().remove();
+    xsdDoc = null;
+
+    const xmlDocValid = libxml.parseXml('<comment>A comment</comment>');
+    const xmlDocInvalid = libxml.parseXml('<commentt>A comment</commentt>');
+
+    for (let i = 0; i < 3; i += 1) {
+      expect(xmlDocValid.validate(schema)).toBe(true);
+      expect(xmlDocValid.validationErrors.length).toBe(0);
+
+      expect(xmlDocInvalid.validate(schema)).toBe(false);
+      expect(xmlDocInvalid.validationErrors.length).toBe(1);
+    }
+
+    const shared = new libxml.Schema(schema.share());
+    expect(schema.share()).toBe(schema.share());
+    expect(xmlDocValid.validate(shared)).toBe(true);
+  });
+
+  it('validateAsync', async () => {
+    const xsd =
+      '<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema"><xs:element name="comment" type="xs:string"/></xs:schema>';
+    const xsdDoc = libxml.parseXml(xsd);
+    const schema = new libxml.Schema(xsdDoc);
+    const xmlDocValid = libxml.parseXml('<comment>A comment</comment>');
+    const xmlDocInvalid = libxml.parseXml('<commentt>A comment</commentt>');
+
+    expect(() => xmlDocValid.validateAsync()).toThrow('Must pass xsd');
+    expect(() => xmlDocValid.validateAsync(0)).toThrow('Must pass XmlDocument');
+
+    const results = await Promise.all([
+      xmlDocValid.validateAsync(schema),
+      xmlDocInvalid.validateAsync(xsdDoc),
+    ]);
+
+    expect(results).toEqual([true, false]);
+    expect(xmlDocValid.validationErrors.length).toBe(0);
+    expect(xmlDocInvalid.validationErrors.length).toBe(1);
+    expect(xmlDocInvalid.validationErrors[0]).toBeInstanceOf(Error);
+    expect(xmlDocInvalid.validationErrors[0].line).toBe(1);
+  });
+
+  it('validateAsync while the document changes', async () => {
+    const xsdDoc = libxml.parseXml(
+      '<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema">' +
+        '<xs:element name="list"><xs:complexType><xs:sequence>' +
+        '<xs:element name="item" maxOccurs="unbounded"><xs:complexType>' +
+        '<xs:attribute name="id" type="xs:ID"/>' +
+        '</xs:complexType></xs:element>' +
+        '</xs:sequence></xs:complexType></xs:element></xs:schema>'
+    );
+    const schema = new libxml.Schema(xsdDoc);
+    const items = Array.from({ length: 1000 }, (_, i) => `<item id="i${i}"/>`);
+    const xmlDoc = libxml.parseXml(`<list>${items.join('')}</list>`);
+
+    // overlapping validations and edits on the JS thread meanwhile
+    const pending = [
+      xmlDoc.validateAsync(schema),
+      xmlDoc.validateAsync(xsdDoc),
+    ];
+    const root = xmlDoc.root();
+    for (let i = 0; i < 100; i += 1) {
+      root.child(0).remove();
+      root.node('other').attr({ id: `o${i}` });
+      root.get(`item[@id="i${i + 500}"]`).attr({ id: `n${i}` });
+    }
+    expect(xmlDoc.find('//*[@id]').length).toBe(1000);
+    expect(xmlDoc.validate(schema)).toBe(false);
+
+    // the result is for the document as it was when validation started
+    expect(await Promise.all(pending)).toEqual([true, true]);
+    expect(xmlDoc.validationErrors.length).toBe(0);
+    expect(await xmlDoc.validateAsync(schema)).toBe(false);
+  });
+
+  it('compiled schema inputs', () => {
+    expect(() => new libxml.Schema()).toThrow('document argument required');
+    expect(() => new libxml.Schema({})).toThrow(
+      'document argument must be an instance of Document'
+    );
+    expect(() => new libxml.Schema(0)).toThrow(
+      'Shared schema is no longer available'
+    );
+
+    let err = null;
+    try {
+      // eslint-disable-next-line no-new
+      new libxml.Schema(
+        libxml.parseXml('<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema"><xs:element/></xs:schema>')
+      );
+    } catch (e) {
+      err = e;
+    }
+    expect(err.message).toBe('Invalid XSD schema');
+    expect(err.errors.length).toBeGreaterThan(0);
+  });
+
   it('rngValidate', () => {
     // see http://relaxng.org/ for more infos about RELAX NG
 
@@ -309,6 +413,22 @@ describe('document', () => {
 
     expect(xmlDocInvalid.rngValidate(rngDoc)).toBe(false);
     expect(xmlDocInvalid.validationErrors.length).toBe(1);
+
+    const schema = new libxml.RelaxNGSchema(rngDoc);
+    expect(schema).toBeInstanceOf(libxml.RelaxNGSchema);
+
+    // validation contexts are reused between calls
+    for (let i = 0; i < 3; i += 1) {
+      expect(xmlDocValid.rngValidate(schema)).toBe(true);
+      expect(xmlDocValid.validationErrors.length).toBe(0);
+
+      expect(xmlDocInvalid.rngValidate(schema)).toBe(false);
+      expect(xmlDocInvalid.validationErrors.length).toBe(1);
+    }
+
+    expect(() => new libxml.RelaxNGSchema(libxml.parseXml('<foo/>'))).toThrow(
+      'Invalid RELAX NG schema'
+    );
   });
 
   it('schematronValidate', () => {
@@ -364,6 +484,17 @@ describe('document', () => {
 
     expect(xmlDocInvalid.schematronValidate(schDoc)).toBe(false);
     expect(xmlDocInvalid.validationErrors.length).toBe(1);
+
+    const schema = new libxml.SchematronSchema(schDoc);
+    expect(schema).toBeInstanceOf(libxml.SchematronSchema);
+
+    for (let i = 0; i < 3; i += 1) {
+      expect(xmlDocValid.schematronValidate(schema)).toBe(true);
+      expect(xmlDocValid.validationErrors.length).toBe(0);
+
+      expect(xmlDocInvalid.schematronValidate(schema)).toBe(false);
+      expect(xmlDocInvalid.validationErrors.length).toBe(1);
+    }
   });
 
   it('validate memory usage', async () => {
@@ -41,6 +41,8 @@ describe('element', () => {
 
     expect(elem.type()).toBe('element');
     expect(elem.doc()).toBe(doc);
+    expect(elem.document).toBe(doc);
+    expect(doc.root().document).toBe(doc);
   });
 
   it('remove', () => {
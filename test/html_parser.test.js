@@ -36,6 +36,21 @@ describe('html parser', () => {
     attempt_parse(null);
   });
 
+  it('parse async', async () => {
+    const filename = `${__dirname}/fixtures/parser.html`;
+
+    for (const encoding of ['utf8', null]) {
+      // eslint-disable-next-line no-sync
+      const str = fs.readFileSync(filename, encoding);
+
+      const doc = await libxml.parseHtmlAsync(str);
+
+      expect(doc.root().name()).toBe('html');
+      expect(doc.get('head/title').text()).toBe('Test HTML document');
+      expect(doc.get('body/span').text()).toBe('HTML content!');
+    }
+  });
+
   // Although libxml defaults to a utf-8 encoding, if not specifically specified
   // it will guess the encoding based on meta http-equiv tags available
   // This test shows that the "guessed" encoding can be overridden
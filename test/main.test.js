@@ -8,9 +8,18 @@ describe('main', () => {
     expect(typeof libxml.libxml_version == 'string').toBeTruthy();
     expect(typeof libxml.libxml_parser_version == 'string').toBeTruthy();
     expect(typeof libxml.libxml_debug_enabled == 'boolean').toBeTruthy();
+    expect(typeof libxml.libxml_memory_debug == 'boolean').toBeTruthy();
   });
 
   it('memoryUsage', () => {
     expect(typeof libxml.memoryUsage() === 'number').toBeTruthy();
   });
+
+  it('memoryUsage tracks allocations', () => {
+    const before = libxml.memoryUsage();
+    // eslint-disable-next-line no-unused-vars
+    const doc = libxml.parseXml(`<root>${'<child/>'.repeat(1000)}</root>`);
+
+    expect(libxml.memoryUsage()).toBeGreaterThan(before);
+  });
 });
@@ -112,6 +112,71 @@ describe('memory management', () => {
     expect(libxml.memoryUsage() <= xml_memory_after_document).toBeTruthy();
   });
 
+  it('wrappers of a large detached subtree freed', async () => {
+    const { traceGC, awaitGC } = setupGC();
+    const items = '<item><name>n</name><value>v</value></item>'.repeat(10000);
+    const doc = libxml.parseXml(`<root><list>${items}</list></root>`);
+    const xml_memory_after_document = libxml.memoryUsage();
+
+    let list = doc.get('//list');
+    list.remove();
+    let nodes = list.find('.//*');
+    expect(nodes).toHaveLength(30000);
+
+    traceGC(list, 'list');
+    list = nodes = null;
+
+    await awaitGC('list');
+    global.gc(true);
+    await new Promise(resolve => setTimeout(resolve, 1));
+
+    expect(libxml.memoryUsage() < xml_memory_after_document).toBeTruthy();
+  }, 10_000);
+
+  it('detached subtree kept for a wrapped descendant', async () => {
+    const { traceGC, awaitGC } = setupGC();
+    const doc = makeDocument();
+
+    // the detached subtree stays for as long as any wrapper in it does
+    const center = doc.get('//center');
+    let middle = doc.get('//middle');
+    middle.remove();
+
+    traceGC(middle, 'middle');
+    middle = null;
+    await awaitGC('middle');
+    global.gc(true);
+    await new Promise(resolve => setTimeout(resolve, 1));
+
+    expect(center.parent().parent().name()).toBe('middle');
+    expect(center.name()).toBe('center');
+  });
+
+  it('detached subtree of a deep document freed', async () => {
+    const { traceGC, awaitGC } = setupGC();
+    const depth = 2000;
+    const open = '<a><b/>'.repeat(depth);
+    const xml = `<root>${open}${'</a>'.repeat(depth)}</root>`;
+    const doc = libxml.parseXml(xml, { huge: true });
+    const xml_memory_after_document = libxml.memoryUsage();
+
+    let nodes = doc.find('//*');
+    expect(nodes).toHaveLength(2 * depth + 1);
+
+    let middle = nodes.filter((node) => node.name() === 'a')[depth / 2];
+    middle.remove();
+    expect(doc.find('//b')).toHaveLength(depth / 2);
+
+    traceGC(middle, 'middle');
+    middle = nodes = null;
+
+    await awaitGC('middle');
+    global.gc(true);
+    await new Promise(resolve => setTimeout(resolve, 1));
+
+    expect(libxml.memoryUsage() < xml_memory_after_document).toBeTruthy();
+  }, 10_000);
+
   it('namespace list freed', async () => {
     const { traceGC, awaitGC } = setupGC();
     let xmlMemBefore;
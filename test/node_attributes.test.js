@@ -70,5 +70,6 @@ describe('node attributes', () => {
     expect(elem.attr('foo').parent()).toBe(elem);
     // get document
     expect(elem.attr('foo').doc()).toBe(doc);
+    expect(elem.attr('foo').document).toBe(doc);
   });
 });
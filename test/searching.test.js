@@ -75,6 +75,45 @@ describe('searching', () => {
     }
   });
 
+  it('find with compiled xpath', () => {
+    const doc = libxml.parseXml(
+      '<root><child id="1"><grandchild/></child><child id="2"/></root>'
+    );
+    const xpath = libxml.compileXPath('child[@id]');
+
+    expect(xpath).toBeInstanceOf(libxml.XPath);
+    expect(xpath.toString()).toBe('child[@id]');
+    expect(doc.find(xpath).length).toBe(2);
+    expect(doc.get(xpath)).toBe(doc.root().child(0));
+    expect(doc.get(libxml.compileXPath('count(//child)'))).toBe(2);
+  });
+
+  it('compileXPath rejects invalid expressions', () => {
+    expect(() => libxml.compileXPath('child[')).toThrow();
+  });
+
+  it('xpath cache', () => {
+    const doc = libxml.parseXml('<root><child/></root>');
+    const expression = `child[${Date.now()} > 0]`;
+
+    const before = libxml.xpathCacheStats();
+    doc.find(expression);
+    doc.find(expression);
+    doc.find(expression);
+    const after = libxml.xpathCacheStats();
+
+    expect(after.misses - before.misses).toBe(1);
+    expect(after.hits - before.hits).toBe(2);
+    expect(after.size).toBeLessThanOrEqual(after.capacity);
+
+    libxml.setXPathCacheSize(1);
+    doc.find('child');
+    doc.find(expression);
+    expect(libxml.xpathCacheStats().size).toBe(1);
+    expect(doc.find(expression).length).toBe(1);
+    libxml.setXPathCacheSize(before.capacity);
+  });
+
   const uri = 'nsuri';
   const prefix = 'pefname';
 
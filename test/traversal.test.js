@@ -102,4 +102,84 @@ describe('traversal', () => {
     expect(child.prevElement().prevElement()).toBe(null);
     expect(child.nextElement().nextElement()).toBe(null);
   });
+
+  it('indexed_children', () => {
+    const items = Array.from({ length: 100 }, (_, i) => `<c${i}/>`);
+    const doc = libxml.parseXml(`<root>${items.join('')}</root>`);
+    const root = doc.root();
+
+    for (let i = 0; i < 100; i += 1) {
+      expect(root.child(i).name()).toBe(`c${i}`);
+    }
+    expect(root.childNodes(99).name()).toBe('c99');
+    expect(root.child(100)).toBe(null);
+    expect(root.child(-1).name()).toBe('c0');
+
+    // the positions follow every change to the children
+    root.child(10).remove();
+    expect(root.child(10).name()).toBe('c11');
+    expect(root.child(99)).toBe(null);
+
+    root.child(20).addPrevSibling(new libxml.Element(doc, 'before'));
+    expect(root.child(20).name()).toBe('before');
+    expect(root.child(21).name()).toBe('c21');
+
+    root.child(30).replace(new libxml.Element(doc, 'replaced'));
+    expect(root.child(30).name()).toBe('replaced');
+
+    root.addChild(new libxml.Element(doc, 'last'));
+    expect(root.child(100).name()).toBe('last');
+
+    doc.get('//c50').remove();
+    expect(root.child(50).name()).toBe('c51');
+
+    root.text('gone');
+    expect(root.child(0).type()).toBe('text');
+    expect(root.child(10)).toBe(null);
+  });
+
+  it('indexed_children_while_building_another_tree', () => {
+    const items = Array.from({ length: 100 }, (_, i) => `<c${i}/>`);
+    const doc = libxml.parseXml(`<root>${items.join('')}</root>`);
+    const root = doc.root();
+    const out = new libxml.Document();
+    const list = out.node('list');
+
+    for (let i = 0; i < 100; i += 1) {
+      const child = root.child(i);
+      expect(child.name()).toBe(`c${i}`);
+      list.addChild(new libxml.Element(out, child.name()));
+      list.child(0).remove();
+    }
+
+    // the index still follows changes to the element itself
+    root.child(20).remove();
+    expect(root.child(20).name()).toBe('c21');
+  });
+
+  it('indexed_children_with_content_edits', () => {
+    const items = Array.from({ length: 100 }, (_, i) => `<c${i}>${i}</c${i}>`);
+    const doc = libxml.parseXml(`<root>${items.join('')}</root>`);
+    const root = doc.root();
+
+    // creating nodes and editing content leave the positions as they are
+    for (let i = 0; i < 100; i += 1) {
+      const child = root.child(i);
+      expect(child.name()).toBe(`c${i}`);
+      child.text(`edited ${i}`);
+      child.attr({ n: `${i}` });
+      child.node('inner', 'x');
+      new libxml.Element(doc, 'unused');
+    }
+    expect(root.child(99).text()).toBe('edited 99x');
+    expect(root.child(50).attr('n').value()).toBe('50');
+
+    root.child(40).cdata('data');
+    expect(root.child(40).child(2).type()).toBe('cdata');
+
+    root.child(60).remove();
+    expect(root.child(60).name()).toBe('c61');
+    root.cdata('end');
+    expect(root.child(99).type()).toBe('cdata');
+  });
 });
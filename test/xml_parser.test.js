@@ -121,6 +121,199 @@ describe('xml parser', () => {
     expect(err.code).toBe(errorControl.code);
   });
 
+  it('parse_large_string', () => {
+    // parsed in chunks, the pairs straddle the chunk boundaries
+    const text = '\u{1F600}é'.repeat(200000);
+    const doc = libxml.parseXml(`<root><a>${text}</a><b/></root>`);
+
+    expect(doc.get('a').text()).toBe(text);
+    expect(doc.root().childNodes().length).toBe(2);
+
+    expect(() =>
+      libxml.parseXml(`<root>${'<a/>'.repeat(100000)}</rot>`)
+    ).toThrow();
+    const recovered = libxml.parseXml(
+      `<root>${'<a/>'.repeat(100000)}</rot>`,
+      { recover: true }
+    );
+    expect(recovered.find('//a').length).toBe(100000);
+    expect(recovered.errors.length).toBeGreaterThan(0);
+  });
+
+  it('parse_async', async () => {
+    const filename = `${__dirname}/fixtures/parser.xml`;
+    // eslint-disable-next-line no-sync
+    const str = fs.readFileSync(filename, 'utf8');
+
+    const doc = await libxml.parseXmlAsync(str);
+
+    expect(doc.root().name()).toBe('root');
+    expect(doc.get('child/grandchild').text()).toBe('with love');
+    expect(doc.errors).toEqual([]);
+    expect(doc.toString()).toBe(str);
+  });
+
+  it('parse_async_null_options', async () => {
+    const xml = await libxml.parseXmlAsync('<root/>', null);
+    expect(xml.root().name()).toBe('root');
+
+    const html = await libxml.parseHtmlAsync('<p>x</p>', null);
+    expect(html.get('//p').text()).toBe('x');
+  });
+
+  it('parse_async_buffer', async () => {
+    const filename = `${__dirname}/fixtures/parser-utf16.xml`;
+    // eslint-disable-next-line no-sync
+    const buf = fs.readFileSync(filename);
+
+    const doc = await libxml.parseXmlAsync(buf);
+
+    expect(doc.encoding()).toBe('UTF-16');
+    expect(doc.root().name()).toBe('root');
+  });
+
+  it('recoverable_parse_async', async () => {
+    const filename = `${__dirname}/fixtures/warnings/ent9.xml`;
+    // eslint-disable-next-line no-sync
+    const str = fs.readFileSync(filename, 'utf8');
+
+    const doc = await libxml.parseXmlAsync(str);
+
+    expect(doc.errors.length).toBe(1);
+    const err = doc.errors[0];
+
+    expect(err).toBeInstanceOf(Error);
+    expect(err.domain).toBe(3);
+    expect(err.column).toBe(8);
+    expect(err.line).toBe(6);
+    expect(err.code).toBe(201);
+    expect(err.str1).toBe('prefix');
+  });
+
+  it('createParserOptions', async () => {
+    const options = libxml.createParserOptions({
+      noblanks: true,
+      baseUrl: 'http://example.com/a.xml',
+      maxErrors: 1,
+      recover: true,
+    });
+    const xml = '<root>\n  <a x="1" x="2"/>\n  <a x="1" x="2"/>\n</root>';
+
+    for (let i = 0; i < 3; i += 1) {
+      const doc = libxml.parseXml(xml, options);
+
+      expect(doc.root().childNodes()).toHaveLength(2);
+      expect(doc.errors).toHaveLength(1);
+    }
+
+    const doc = await libxml.parseXmlAsync(xml, options);
+    expect(doc.root().childNodes()).toHaveLength(2);
+
+    const reader = new libxml.TextReader(xml, options);
+    reader.read();
+    reader.read();
+    expect(reader.name()).toBe('a');
+
+    const html = libxml.createParserOptions({});
+    expect(libxml.parseHtmlFragment('<a/>', html).toString()).toBe(
+      libxml.parseHtmlFragment('<a/>').toString()
+    );
+
+    expect(() => libxml.createParserOptions('x')).toThrow(
+      'parser options must be an object'
+    );
+  });
+
+  it('lazy errors', async () => {
+    const xml = `<root>${'<a x="1" x="2"/>'.repeat(5)}</root>`;
+
+    const doc = libxml.parseXml(xml, { recover: true });
+    const { errors } = doc;
+
+    expect(errors.length).toBe(5);
+    expect(doc.errors).toBe(errors);
+    errors.shift();
+    expect(doc.errors.length).toBe(4);
+    expect(errors[0].code).toBe(42);
+
+    let capped = libxml.parseXml(xml, { recover: true, maxErrors: 2 });
+    expect(capped.errors).toHaveLength(2);
+    capped = libxml.parseXml(xml, { recover: true, maxErrors: 0 });
+    expect(capped.errors).toEqual([]);
+    capped = await libxml.parseXmlAsync(xml, { recover: true, maxErrors: 3 });
+    expect(capped.errors).toHaveLength(3);
+
+    doc.errors = [];
+    expect(doc.errors).toEqual([]);
+  });
+
+  it('parser pool', () => {
+    libxml.parseXml('<root/>');
+    const before = libxml.parserPoolStats();
+    expect(before.size).toBeGreaterThan(0);
+    expect(before.size).toBeLessThanOrEqual(before.capacity);
+
+    const blank = '<root>\n  <a/>\n</root>';
+    const noblanks = libxml.parseXml(blank, { noblanks: true });
+    expect(noblanks.root().childNodes()).toHaveLength(1);
+    // options of an earlier parse do not stick to the pooled context
+    expect(libxml.parseXml(blank).root().childNodes()).toHaveLength(3);
+    const cdata = libxml.parseXml('<x><![CDATA[hi]]></x>', { nocdata: true });
+    expect(cdata.root().child(0).type()).toBe('text');
+    // nor do the SAX callbacks those options replace
+    const kept = libxml.parseXml('<x><![CDATA[hi]]></x>');
+    expect(kept.root().child(0).type()).toBe('cdata');
+    expect(() => libxml.parseXml('<root>')).toThrow();
+    expect(libxml.parseXml('<b/>').root().name()).toBe('b');
+    expect(libxml.parseHtml('<p>x</p>').get('//p').text()).toBe('x');
+
+    // parses share a dictionary until it grows too big and is replaced,
+    // documents from before keep theirs
+    const early = libxml.parseXml('<early><named/></early>');
+    const names = Array.from({ length: 8000 }, (_, i) => `<name-${i}/>`);
+    libxml.parseXml(`<many>${names.join('')}</many>`);
+    libxml.parseXml('<late><named/></late>');
+    expect(early.root().name()).toBe('early');
+    expect(early.root().child(0).name()).toBe('named');
+
+    const after = libxml.parserPoolStats();
+    expect(after.hits - before.hits).toBeGreaterThanOrEqual(4);
+
+    libxml.setParserPoolSize(0);
+    expect(libxml.parserPoolStats().size).toBe(0);
+    expect(libxml.parseXml('<c/>').root().name()).toBe('c');
+    expect(libxml.parserPoolStats().size).toBe(0);
+    libxml.setParserPoolSize(before.capacity);
+
+    expect(() => libxml.setParserPoolSize(-1)).toThrow(
+      'pool size must be a non-negative number'
+    );
+  });
+
+  it('fatal_error_async', async () => {
+    const filename = `${__dirname}/fixtures/errors/comment.xml`;
+    // eslint-disable-next-line no-sync
+    const str = fs.readFileSync(filename, 'utf8');
+
+    const err = await libxml.parseXmlAsync(str).catch((e) => e);
+
+    expect(err).toBeInstanceOf(Error);
+    expect(err.code).toBe(9);
+    expect(err.line).toBe(5);
+  });
+
+  it('parse_async_concurrent', async () => {
+    const docs = await Promise.all(
+      Array.from({ length: 16 }, (_, i) =>
+        libxml.parseXmlAsync(`<root><child id="${i}"/></root>`)
+      )
+    );
+
+    docs.forEach((doc, i) => {
+      expect(doc.get('child').attr('id').value()).toBe(`${i}`);
+    });
+  });
+
   it('text path', () => {
     const xml = '<?xml version="1.0" encoding="utf-8"?><Name>Test</Name>';
     const doc = libxml.parseXmlString(xml);
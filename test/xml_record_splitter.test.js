@@ -0,0 +1,86 @@
+import { Readable } from "node:stream";
+import * as libxml from "../index.js";
+
+describe('xml record splitter', () => {
+  const xml =
+    '<feed xmlns="urn:feed" xmlns:x="urn:x">\n' +
+    '  <meta><title>feed</title></meta>\n' +
+    '  <record id="1"><x:name>first</x:name><!-- c --></record>\n' +
+    '  <record id="2"><x:name>second</x:name></record>\n' +
+    '  <group><record id="3"><record id="4"/></record></group>\n' +
+    '</feed>';
+
+  it('splitRecords', async () => {
+    const chunks = [];
+    for (let i = 0; i < xml.length; i += 5) {
+      chunks.push(Buffer.from(xml.slice(i, i + 5)));
+    }
+
+    const records = [];
+    for await (const record of libxml.splitRecords(Readable.from(chunks), {
+      names: 'record',
+    })) {
+      records.push(record);
+    }
+
+    // nested records are part of the outer one
+    expect(records.map((record) => record.attr('id').value())).toEqual([
+      '1',
+      '2',
+      '3',
+    ]);
+
+    const [first] = records;
+    expect(first.doc().root()).toBe(first);
+    expect(first.parent()).toBe(first.doc());
+    expect(first.namespace().href()).toBe('urn:feed');
+    expect(first.get('x:name', { x: 'urn:x' }).text()).toBe('first');
+    expect(first.childNodes().length).toBe(2);
+    expect(records[2].find('f:record', { f: 'urn:feed' }).length).toBe(1);
+  });
+
+  it('patterns', () => {
+    const splitter = new libxml.RecordSplitter({
+      patterns: '/f:feed/f:record',
+      namespaces: { f: 'urn:feed' },
+    });
+
+    const records = [
+      ...splitter.push(xml.slice(0, 100)),
+      ...splitter.push(xml.slice(100), true),
+    ];
+    expect(records.map((record) => record.toString())).toEqual([
+      '<record xmlns="urn:feed" xmlns:x="urn:x" id="1">' +
+        '<x:name>first</x:name><!-- c --></record>',
+      '<record xmlns="urn:feed" xmlns:x="urn:x" id="2">' +
+        '<x:name>second</x:name></record>',
+    ]);
+
+    expect(() => splitter.push('')).toThrow('RecordSplitter is closed');
+  });
+
+  it('sax1', () => {
+    const message = 'Bad Argument: RecordSplitter does not support sax1';
+    const filter = { names: 'r' };
+
+    expect(() => new libxml.RecordSplitter(filter, { sax1: true })).toThrow(
+      message
+    );
+    const options = libxml.createParserOptions({ sax1: true });
+    expect(() => new libxml.RecordSplitter(filter, options)).toThrow(message);
+  });
+
+  it('errors', () => {
+    const splitter = new libxml.RecordSplitter({ names: 'r' });
+
+    expect(splitter.push('<a><r>1</r>')).toHaveLength(1);
+    expect(() => splitter.push('<r></a>')).toThrow(
+      'Opening and ending tag mismatch'
+    );
+    expect(() => splitter.push('')).toThrow('RecordSplitter is closed');
+
+    expect(() => new libxml.RecordSplitter()).toThrow(
+      'RecordSplitter requires a filter'
+    );
+  });
+});
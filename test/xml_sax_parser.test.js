@@ -1,9 +1,11 @@
 import fs from "node:fs";
+import { Readable } from "node:stream";
+import { pipeline } from "node:stream/promises";
 import * as libxml from "../index.js";
 
 global.gc ??= (typeof Bun !== 'undefined' ? Bun.gc : undefined);
 
-function createParser(parserType, callbacks) {
+function createParser(parserType, callbacks, options) {
   // can connect by passing in as arguments to constructor
   const parser = new libxml[parserType]({
     startDocument(...args) {
@@ -33,7 +35,7 @@ function createParser(parserType, callbacks) {
     error(...args) {
       callbacks.error.push(args);
     },
-  });
+  }, options);
 
   // can also connect directly because it is an event emitter
   parser.on('cdata', (...args) => {
@@ -160,6 +162,544 @@ describe('xml sax parser', () => {
     expect(callbacks).toEqual(control);
   });
 
+  it('sax buffer', () => {
+    // eslint-disable-next-line no-sync
+    const buf = fs.readFileSync(filename);
+
+    let callbacks = callbackTest();
+    createParser('SaxParser', callbacks).parseString(buf);
+    expect(callbacks).toEqual(callbackControl());
+
+    // a view into a larger buffer is read from its own offset
+    callbacks = callbackTest();
+    const padded = Buffer.concat([Buffer.from('junk'), buf]);
+    createParser('SaxParser', callbacks).parseString(
+      new Uint8Array(padded.buffer, padded.byteOffset + 4, buf.length)
+    );
+    expect(callbacks).toEqual(callbackControl());
+
+    // split in the middle of multi byte characters on purpose
+    callbacks = callbackTest();
+    const parser = createParser('SaxPushParser', callbacks);
+    for (let i = 0; i < buf.length; i += 7) {
+      parser.push(buf.subarray(i, i + 7), i + 7 >= buf.length);
+    }
+    expect(callbacks).toEqual(callbackControl());
+  });
+
+  it('sax buffer encoding', () => {
+    const text = [];
+    const parser = new libxml.SaxParser({
+      characters(chars) {
+        text.push(chars);
+      },
+    });
+
+    const latin1 = '<?xml version="1.0" encoding="ISO-8859-1"?><a>\u00e9</a>';
+
+    parser.parseString(Buffer.from(latin1, 'latin1'));
+    parser.parseString(Buffer.from('\ufeff<a>\u00e9</a>', 'utf16le'));
+    expect(text).toEqual(['\u00e9', '\u00e9']);
+
+    expect(() => parser.parseString(new Uint16Array(4))).toThrow(
+      'parseString requires a string or Buffer'
+    );
+  });
+
+  it('sax batched', () => {
+    // eslint-disable-next-line no-sync
+    const str = fs.readFileSync(filename, 'utf8');
+
+    for (const batch of [true, { events: 3 }, { bytes: 1 }]) {
+      const callbacks = callbackTest();
+      const parser = createParser('SaxParser', callbacks, { batch });
+
+      parser.parseString(str);
+      expect(callbacks).toEqual(callbackControl());
+    }
+  });
+
+  it('sax async', async () => {
+    // eslint-disable-next-line no-sync
+    const str = fs.readFileSync(filename, 'utf8');
+
+    const results = await Promise.all(
+      [undefined, { events: 2 }, { bytes: 1 }].map(async (batch) => {
+        const callbacks = callbackTest();
+        const parser = createParser('SaxParser', callbacks);
+
+        expect(await parser.parseStringAsync(str, batch)).toBe(true);
+        return callbacks;
+      })
+    );
+
+    for (const callbacks of results) {
+      expect(callbacks).toEqual(callbackControl());
+    }
+  });
+
+  it('sax async listener error', async () => {
+    let count = 0;
+    const parser = new libxml.SaxParser({
+      startElementNS() {
+        count += 1;
+        throw new Error('stop');
+      },
+    });
+
+    const doc = `<root>${'<child/>'.repeat(1000)}</root>`;
+    await expect(parser.parseStringAsync(doc, { events: 10 })).rejects.toThrow(
+      'stop'
+    );
+    expect(count).toBe(1);
+  });
+
+  it('sax_push_chunked batched', () => {
+    const callbacks = callbackTest();
+    // eslint-disable-next-line no-sync
+    const str_ary = fs.readFileSync(filename, 'utf8').split('\n');
+    const parser = createParser('SaxPushParser', callbacks, {
+      batch: { events: 2 },
+    });
+
+    for (let i = 0; i < str_ary.length; i += 1) {
+      parser.push(str_ary[i], i + 1 === str_ary.length);
+    }
+
+    const control = callbackControl();
+
+    control.error = [['Premature end of data in tag error line 1\n']];
+    expect(callbacks).toEqual(control);
+  });
+
+  it('sax batch decoding', () => {
+    const batches = [];
+    const events = [];
+    const parser = new libxml.SaxParser();
+
+    parser.setBatchCallback((ops, text) => {
+      expect(ops).toBeInstanceOf(Uint32Array);
+      batches.push(ops.length);
+      libxml.decodeSaxBatch(ops, text, (...args) => events.push(args));
+    }, 100);
+
+    // strings outside the BMP take two UTF-16 code units
+    parser.parseString(
+      '<r xmlns="urn:a" xmlns:b="urn:b" b:x="\u{1F600}é"><b:c>\u{1F600}z</b:c></r>'
+    );
+
+    expect(batches.length).toBe(1);
+    expect(events).toEqual([
+      ['startDocument'],
+      [
+        'startElementNS',
+        'r',
+        [['x', 'b', 'urn:b', '\u{1F600}é']],
+        null,
+        'urn:a',
+        [
+          [null, 'urn:a'],
+          ['b', 'urn:b'],
+        ],
+      ],
+      ['startElementNS', 'c', [], 'b', 'urn:b', []],
+      ['characters', '\u{1F600}z'],
+      ['endElementNS', 'c', 'b', 'urn:b'],
+      ['endElementNS', 'r', null, 'urn:a'],
+      ['endDocument'],
+    ]);
+
+    // back to plain events
+    const names = [];
+    parser.setBatchCallback(null);
+    parser.on('startElementNS', (name) => names.push(name));
+    parser.parseString('<a/>');
+    expect(names).toEqual(['a']);
+  });
+
+  it('sax batch with malformed UTF-8', () => {
+    const parse = (batch) => {
+      const events = [];
+      const parser = new libxml.SaxParser({ batch });
+
+      for (const event of ['startElementNS', 'characters', 'error']) {
+        parser.on(event, (...args) => events.push([event, args[0]]));
+      }
+      parser.parseString(
+        Buffer.concat([
+          Buffer.from('<r><a>'),
+          Buffer.from([0xe9, 0xff, 0xc3]),
+          Buffer.from('</a><b>\u00e9 after</b></r>'),
+        ])
+      );
+      return events;
+    };
+
+    // strings after the bad bytes are still sliced at the right offsets
+    expect(parse(true)).toEqual(parse(false));
+  });
+
+  it('interned names', () => {
+    const names = [];
+    const parser = new libxml.SaxPushParser({
+      startElementNS(name, attrs) {
+        names.push(name, attrs.length ? attrs[0][0] : null);
+      },
+    });
+
+    parser.push('<root>');
+    for (let i = 0; i < 10; i += 1) {
+      parser.push('<item id="1"/>');
+    }
+    parser.push('</root>', true);
+
+    expect(names.filter((name) => name === 'item').length).toBe(10);
+    expect(names.filter((name) => name === 'id').length).toBe(10);
+
+    // every repeated start / end tag and attribute name is a hit
+    const stats = parser.internStats();
+    expect(stats.hits).toBe(29);
+    expect(stats.misses).toBe(3);
+
+    // the cache goes away with the parser context
+    expect(stats.size).toBe(0);
+  });
+
+  it('interned names unbatched', () => {
+    const names = [];
+    const parser = new libxml.SaxParser({
+      startElementNS(name, attrs, prefix, uri) {
+        names.push([name, prefix, uri, attrs.map((attr) => attr[0])]);
+      },
+      endElementNS(name) {
+        names.push([name]);
+      },
+    });
+
+    const items = '<p:item xmlns:p="urn:p" id="1" n="2"/>'.repeat(100);
+    parser.parseString(`<root>${items}</root>`);
+    parser.parseString(`<root>${items}</root>`);
+
+    expect(names.length).toBe(404);
+    expect(names[1]).toEqual(['item', 'p', 'urn:p', ['id', 'n']]);
+    expect(names[401]).toEqual(['item', 'p', 'urn:p', ['id', 'n']]);
+    expect(names[402]).toEqual(['item']);
+    expect(names[403]).toEqual(['root']);
+    expect(parser.internStats().hits).toBeGreaterThan(0);
+  });
+
+  it('nested parse from callback', () => {
+    const names = [];
+    const parser = new libxml.SaxParser({
+      startElementNS(name) {
+        // parsing from within a callback must not clobber the outer input
+        const doc = libxml.parseXml(`<inner-${name}/>`);
+        names.push(name, doc.root().name());
+      },
+    });
+
+    parser.parseString('<root><child/></root>');
+    expect(names).toEqual(['root', 'inner-root', 'child', 'inner-child']);
+  });
+
+  it('sax_push_schema', () => {
+    const xsd =
+      '<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema"><xs:element name="comment" type="xs:string"/></xs:schema>';
+    const schema = new libxml.Schema(libxml.parseXml(xsd));
+    const results = [];
+    const names = [];
+
+    const parser = new libxml.SaxPushParser({
+      startElementNS(name) {
+        names.push(name);
+      },
+      validated(valid, errors) {
+        results.push([valid, errors.length]);
+      },
+    });
+
+    parser.plugSchema(schema);
+    parser.push('<comm');
+    expect(() => parser.plugSchema(schema)).toThrow();
+    parser.push('ent>A comment</comment>', true);
+
+    // plugging the validator in does not hide the SAX events
+    expect(names).toEqual(['comment']);
+    expect(results).toEqual([[true, 0]]);
+
+    expect(() => new libxml.SaxPushParser().plugSchema()).toThrow(
+      'Must pass xsd'
+    );
+  });
+
+  it('sax filter', () => {
+    const doc =
+      '<feed xmlns:x="urn:x"><meta>m</meta><item id="1"><title>a</title>' +
+      '<!--c--></item><x:item><title>b</title></x:item>' +
+      '<group><item id="2"/></group></feed>';
+
+    const collect = (parserType, filter) => {
+      const events = [];
+      const parser = new libxml[parserType]({}, { filter });
+
+      for (const name of [
+        'startDocument',
+        'endDocument',
+        'startElementNS',
+        'endElementNS',
+        'characters',
+        'comment',
+      ]) {
+        parser.on(name, (arg) => events.push([name, arg]));
+      }
+      if (parserType === 'SaxParser') {
+        parser.parseString(doc);
+      } else {
+        parser.push(doc, true);
+      }
+      return events;
+    };
+
+    const items = [
+      ['startDocument', undefined],
+      ['startElementNS', 'item'],
+      ['startElementNS', 'title'],
+      ['characters', 'a'],
+      ['endElementNS', 'title'],
+      ['comment', 'c'],
+      ['endElementNS', 'item'],
+      ['startElementNS', 'item'],
+      ['startElementNS', 'title'],
+      ['characters', 'b'],
+      ['endElementNS', 'title'],
+      ['endElementNS', 'item'],
+      ['startElementNS', 'item'],
+      ['endElementNS', 'item'],
+      ['endDocument', undefined],
+    ];
+
+    expect(collect('SaxParser', { names: 'item' })).toEqual(items);
+    expect(collect('SaxPushParser', { names: ['item'] })).toEqual(items);
+
+    expect(collect('SaxParser', { uris: 'urn:x' })).toEqual([
+      ['startDocument', undefined],
+      ['startElementNS', 'item'],
+      ['startElementNS', 'title'],
+      ['characters', 'b'],
+      ['endElementNS', 'title'],
+      ['endElementNS', 'item'],
+      ['endDocument', undefined],
+    ]);
+
+    expect(
+      collect('SaxParser', {
+        patterns: ['/feed/x:item/title', '//group/item'],
+        namespaces: { x: 'urn:x' },
+      })
+    ).toEqual([
+      ['startDocument', undefined],
+      ['startElementNS', 'title'],
+      ['characters', 'b'],
+      ['endElementNS', 'title'],
+      ['startElementNS', 'item'],
+      ['endElementNS', 'item'],
+      ['endDocument', undefined],
+    ]);
+
+    expect(() => collect('SaxParser', { patterns: '/[' })).toThrow(
+      'Invalid filter pattern: /['
+    );
+    expect(() => collect('SaxParser', { names: 1 })).toThrow(
+      'Bad Argument: filter names, uris and patterns'
+    );
+  });
+
+  it('sax attribute formats', () => {
+    const doc = '<r xmlns="urn:a" xmlns:b="urn:b" id="1" b:x="2"><c/></r>';
+    const expected = {
+      arrays: [
+        [
+          ['id', '', '', '1'],
+          ['x', 'b', 'urn:b', '2'],
+        ],
+        [
+          [null, 'urn:a'],
+          ['b', 'urn:b'],
+        ],
+      ],
+      flat: [
+        ['id', '', '', '1', 'x', 'b', 'urn:b', '2'],
+        [null, 'urn:a', 'b', 'urn:b'],
+      ],
+      object: [
+        { id: '1', 'b:x': '2' },
+        { '': 'urn:a', b: 'urn:b' },
+      ],
+    };
+
+    for (const format of Object.keys(expected)) {
+      for (const batch of [false, true]) {
+        const events = [];
+        const parser = new libxml.SaxParser(
+          {
+            startElementNS(name, attributes, prefix, uri, namespaces) {
+              events.push([attributes, namespaces]);
+            },
+          },
+          { attributes: format, batch }
+        );
+
+        expect(parser.attributeFormat()).toBe(format);
+        parser.parseString(doc);
+        expect(events[0]).toEqual(expected[format]);
+        expect(events[1]).toEqual(
+          format === 'object' ? [{}, {}] : [[], []]
+        );
+      }
+    }
+
+    // changing the format after batching was enabled
+    const events = [];
+    const parser = new libxml.SaxParser(
+      {
+        startElementNS(name, attributes, prefix, uri, namespaces) {
+          events.push([attributes, namespaces]);
+        },
+      },
+      { batch: true }
+    );
+
+    parser.attributeFormat('object');
+    parser.parseString(doc);
+    expect(events[0]).toEqual(expected.object);
+
+    expect(() => new libxml.SaxParser({}, { attributes: 'map' })).toThrow(
+      "attribute format must be 'arrays', 'flat' or 'object'"
+    );
+  });
+
+  it('sax write stream', async () => {
+    const callbacks = callbackTest();
+    const parser = createParser('SaxPushParser', callbacks);
+
+    await pipeline(
+      fs.createReadStream(filename, { highWaterMark: 16 }),
+      parser.createWriteStream()
+    );
+    expect(callbacks).toEqual(callbackControl());
+
+    const failing = new libxml.SaxPushParser({
+      startElementNS() {
+        throw new Error('stop');
+      },
+    });
+    await expect(
+      pipeline(Readable.from(['<a/>']), failing.createWriteStream())
+    ).rejects.toThrow('stop');
+  });
+
+  it('saxEvents', async () => {
+    let read = 0;
+    async function* chunks() {
+      for (const chunk of ['<a x="1">', Buffer.from('t</a>')]) {
+        read += 1;
+        yield chunk;
+      }
+    }
+
+    const iterator = libxml.saxEvents(chunks());
+    const first = await iterator.next();
+
+    expect(first.value).toEqual(['startDocument']);
+    // nothing is read ahead of the consumer
+    expect(read).toBe(1);
+
+    const rest = [];
+    for await (const event of iterator) {
+      rest.push(event);
+    }
+    expect(read).toBe(2);
+    expect(rest).toEqual([
+      ['startElementNS', 'a', [['x', null, null, '1']], null, null, []],
+      ['characters', 't'],
+      ['endElementNS', 'a', null, null],
+      ['endDocument'],
+    ]);
+  });
+
+  it('push parser closed from a listener', () => {
+    for (const batch of [false, { events: 1 }]) {
+      const names = [];
+      const parser = new libxml.SaxPushParser(
+        {
+          startElementNS(name) {
+            names.push(name);
+            if (name === 'stop') {
+              parser.close();
+            }
+          },
+        },
+        { batch }
+      );
+
+      parser.push('<root><a/><stop/><b/><c/>');
+      parser.push('<d/></root>', true);
+      expect(names).toEqual(['root', 'a', 'stop']);
+    }
+  });
+
+  it('saxEvents break', async () => {
+    let done = false;
+    async function* chunks() {
+      try {
+        for (;;) {
+          yield '<a><b/>';
+        }
+      } finally {
+        done = true;
+      }
+    }
+
+    const names = [];
+    for await (const [event, name] of libxml.saxEvents(chunks())) {
+      if (event === 'startElementNS') {
+        names.push(name);
+        if (names.length === 3) {
+          break;
+        }
+      }
+    }
+
+    expect(names).toEqual(['a', 'b', 'a']);
+    // the source is closed along with the parser
+    expect(done).toBe(true);
+  });
+
+  it('validateStream', async () => {
+    const xsd =
+      '<xs:schema xmlns:xs="http://www.w3.org/2001/XMLSchema"><xs:element name="comment" type="xs:string"/></xs:schema>';
+    const xsdDoc = libxml.parseXml(xsd);
+
+    let result = await libxml.validateStream(
+      new libxml.Schema(xsdDoc),
+      Readable.from([Buffer.from('<comment>A '), Buffer.from('comment</comment>')])
+    );
+    expect(result).toEqual({ valid: true, errors: [] });
+
+    result = await libxml.validateStream(
+      xsdDoc,
+      Readable.from(['<?xml version="1.0"?>\n', '<commentt>A comment</commentt>'])
+    );
+    expect(result.valid).toBe(false);
+    expect(result.errors.length).toBe(1);
+    expect(result.errors[0].line).toBe(2);
+
+    // malformed input is reported, not thrown
+    result = await libxml.validateStream(xsdDoc, Readable.from(['<comment>']));
+    expect(result.valid).toBe(false);
+    expect(result.errors.length).toBeGreaterThan(0);
+  });
+
   // eslint-disable-next-line jest/expect-expect
   it('string_parser', () => {
     const callbacks = callbackTest();
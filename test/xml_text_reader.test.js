@@ -0,0 +1,133 @@
+import * as libxml from "../index.js";
+
+describe('xml text reader', () => {
+  const xml =
+    '<root xmlns:x="urn:x">' +
+    '<item id="1" x:flag="yes">first</item>' +
+    '<item id="2"><![CDATA[second]]></item>' +
+    '<!-- note -->' +
+    '<empty/>' +
+    '</root>';
+
+  it('read', () => {
+    const reader = new libxml.TextReader(xml);
+    const events = [];
+
+    while (reader.read()) {
+      events.push([reader.nodeType(), reader.name(), reader.depth()]);
+    }
+
+    expect(events).toEqual([
+      [libxml.TextReader.ELEMENT, 'root', 0],
+      [libxml.TextReader.ELEMENT, 'item', 1],
+      [libxml.TextReader.TEXT, '#text', 2],
+      [libxml.TextReader.END_ELEMENT, 'item', 1],
+      [libxml.TextReader.ELEMENT, 'item', 1],
+      [libxml.TextReader.CDATA, '#cdata-section', 2],
+      [libxml.TextReader.END_ELEMENT, 'item', 1],
+      [libxml.TextReader.COMMENT, '#comment', 1],
+      [libxml.TextReader.ELEMENT, 'empty', 1],
+      [libxml.TextReader.END_ELEMENT, 'root', 0],
+    ]);
+    expect(reader.read()).toBe(false);
+  });
+
+  it('fromFile', () => {
+    const reader = libxml.TextReader.fromFile(
+      `${__dirname}/fixtures/parser.xml`,
+      { noblanks: true }
+    );
+    const names = [];
+
+    while (reader.read()) {
+      if (reader.nodeType() === libxml.TextReader.ELEMENT) {
+        names.push(reader.name());
+      }
+    }
+    expect(names).toEqual(['root', 'child', 'grandchild', 'sibling']);
+    reader.close();
+
+    expect(() =>
+      libxml.TextReader.fromFile(`${__dirname}/fixtures/missing.xml`)
+    ).toThrow('Could not open');
+    expect(() => libxml.TextReader.fromFile(1)).toThrow(
+      'TextReader.fromFile requires a file name'
+    );
+  });
+
+  it('values and attributes', () => {
+    const reader = new libxml.TextReader(Buffer.from(xml));
+
+    reader.read();
+    reader.read();
+    expect(reader.localName()).toBe('item');
+    expect(reader.attributeCount()).toBe(2);
+    expect(reader.getAttribute('id')).toBe('1');
+    expect(reader.getAttribute('missing')).toBeNull();
+    expect(reader.attributes()).toEqual({ id: '1', 'x:flag': 'yes' });
+
+    const names = [];
+    for (let ok = reader.moveToFirstAttribute(); ok; ok = reader.moveToNextAttribute()) {
+      names.push([reader.name(), reader.prefix(), reader.namespaceUri(), reader.value()]);
+    }
+    expect(names).toEqual([
+      ['id', null, null, '1'],
+      ['x:flag', 'x', 'urn:x', 'yes'],
+    ]);
+    expect(reader.moveToElement()).toBe(true);
+
+    reader.read();
+    expect(reader.hasValue()).toBe(true);
+    expect(reader.value()).toBe('first');
+
+    reader.read();
+    reader.read();
+    expect(reader.getAttribute('id')).toBe('2');
+
+    // skip the subtree of the second item
+    reader.next();
+    expect(reader.name()).toBe('#comment');
+    reader.read();
+    expect(reader.isEmptyElement()).toBe(true);
+  });
+
+  it('expand', () => {
+    const reader = new libxml.TextReader(xml);
+    const items = [];
+
+    while (reader.read()) {
+      if (reader.nodeType() === libxml.TextReader.ELEMENT && reader.name() === 'item') {
+        items.push(reader.expand());
+      }
+    }
+    reader.close();
+
+    expect(items.length).toBe(2);
+    expect(items[0].attr('id').value()).toBe('1');
+    expect(items[0].text()).toBe('first');
+    expect(items[0].doc().root()).toBe(items[0]);
+    expect(items[1].text()).toBe('second');
+
+    // namespaces declared on ancestors are carried over
+    expect(items[0].attr('flag').namespace().href()).toBe('urn:x');
+
+    expect(() => reader.read()).toThrow('TextReader is closed');
+  });
+
+  it('errors', () => {
+    const reader = new libxml.TextReader('<root><child></root>');
+    let err = null;
+
+    try {
+      while (reader.read());
+    } catch (e) {
+      err = e;
+    }
+
+    expect(err).toBeInstanceOf(Error);
+    expect(err.code).toBe(76);
+    expect(() => new libxml.TextReader()).toThrow(
+      'TextReader requires a string or Buffer'
+    );
+  });
+});